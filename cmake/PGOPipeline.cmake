@@ -0,0 +1,105 @@
+# Profile-guided optimization pipeline, run in script mode by the "pgo" target:
+#   1. builds a plain Release flipper (the baseline),
+#   2. builds an instrumented flipper (PGO=GENERATE) and runs every training run with it,
+#   3. rebuilds flipper from the recorded profiles (PGO=USE),
+#   4. runs the benchmark scene on the baseline and on the optimized build and reports the frame-time delta.
+#
+# Expected variables: SOURCE_DIR, BINARY_DIR, BUILD_TYPE, EXE, TRAINING_RUNS, BENCHMARK_ARGS.
+# TRAINING_RUNS is a list with one flipper command line per run (e.g. one per recorded gameplay session).
+
+cmake_minimum_required(VERSION 3.22.1)
+
+set(PROFILE_DIR ${BINARY_DIR}/profiles)
+if(CMAKE_HOST_WIN32)
+    set(EXE_SUFFIX ".exe")
+endif()
+
+# @brief Configures and builds flipper in BINARY_DIR/<name> at the given PGO stage.
+# @note The GENERATE and USE stages share one binary dir: GCC names each .gcda after the absolute path of
+# its object file, the USE build only finds the profiles of objects built at the same paths.
+function(pgo_build name stage)
+    message(STATUS "[pgo] Building the ${name} flipper (PGO=${stage})")
+    execute_process(COMMAND ${CMAKE_COMMAND} -S ${SOURCE_DIR} -B ${BINARY_DIR}/${name}
+                            -DCMAKE_BUILD_TYPE=${BUILD_TYPE}
+                            -DPGO=${stage}
+                            -DPGO_PROFILE_DIR=${PROFILE_DIR}
+                    RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "[pgo] Failed to configure the ${name} build.")
+    endif()
+    execute_process(COMMAND ${CMAKE_COMMAND} --build ${BINARY_DIR}/${name} --config ${BUILD_TYPE} --target ${EXE} --parallel
+                    RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "[pgo] Failed to build the ${name} flipper.")
+    endif()
+endfunction()
+
+# @brief Finds the flipper binary of a build, single or multi-config generator.
+function(pgo_executable name out)
+    set(path ${BINARY_DIR}/${name}/${EXE}${EXE_SUFFIX})
+    if(NOT EXISTS ${path})
+        set(path ${BINARY_DIR}/${name}/${BUILD_TYPE}/${EXE}${EXE_SUFFIX})
+    endif()
+    set(${out} ${path} PARENT_SCOPE)
+endfunction()
+
+# @brief Runs flipper with the given command line and returns the average frame time it reported, in us.
+# @note flipper prints it in ms with 3 decimals; math(EXPR) only handles integers.
+function(pgo_run name args out)
+    pgo_executable(${name} exe)
+    separate_arguments(arg_list NATIVE_COMMAND "${args}")
+    execute_process(COMMAND ${exe} ${arg_list}
+                    WORKING_DIRECTORY ${SOURCE_DIR}
+                    RESULT_VARIABLE result
+                    OUTPUT_VARIABLE output)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "[pgo] '${exe} ${args}' failed:\n${output}")
+    endif()
+    string(REGEX MATCH "Average frame time: ([0-9]+)\\.([0-9][0-9][0-9]) ms" match "${output}")
+    if(match)
+        set(ms ${CMAKE_MATCH_1})
+        # Drop the leading zeros of the decimals, math(EXPR) would not read them as base 10
+        string(REGEX REPLACE "^0+([0-9])" "\\1" us ${CMAKE_MATCH_2})
+        math(EXPR frame_us "${ms} * 1000 + ${us}")
+        set(${out} ${frame_us} PARENT_SCOPE)
+    else()
+        set(${out} "" PARENT_SCOPE)
+    endif()
+endfunction()
+
+pgo_build(baseline OFF)
+
+# Old profiles would be merged with the new ones: start from a clean directory
+file(REMOVE_RECURSE ${PROFILE_DIR})
+file(MAKE_DIRECTORY ${PROFILE_DIR})
+pgo_build(optimized GENERATE)
+foreach(run IN LISTS TRAINING_RUNS)
+    message(STATUS "[pgo] Training run: ${run}")
+    pgo_run(optimized "${run}" ignored)
+endforeach()
+
+# Clang writes raw profiles that must be merged before they can be used
+file(GLOB raw_profiles ${PROFILE_DIR}/*.profraw)
+if(raw_profiles)
+    find_program(LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+    execute_process(COMMAND ${LLVM_PROFDATA} merge -output=${PROFILE_DIR}/${EXE}.profdata ${raw_profiles}
+                    RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "[pgo] Failed to merge the raw profiles.")
+    endif()
+endif()
+
+# Rebuilt in place over the instrumented objects, so that the profile names match
+pgo_build(optimized USE)
+
+pgo_run(baseline "${BENCHMARK_ARGS}" baseline_us)
+pgo_run(optimized "${BENCHMARK_ARGS}" optimized_us)
+if(baseline_us STREQUAL "" OR optimized_us STREQUAL "")
+    message(FATAL_ERROR "[pgo] The benchmark scene did not report its frame time.")
+endif()
+
+math(EXPR delta_us "${optimized_us} - ${baseline_us}")
+math(EXPR delta_permille "1000 * (${optimized_us} - ${baseline_us}) / ${baseline_us}")
+message(STATUS "[pgo] Baseline average frame time:  ${baseline_us} us")
+message(STATUS "[pgo] Optimized average frame time: ${optimized_us} us")
+message(STATUS "[pgo] Frame-time delta: ${delta_us} us (${delta_permille} per mille)")
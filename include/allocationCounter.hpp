@@ -0,0 +1,24 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+// @brief Counts the heap allocations made through operator new, to check that frames don't allocate.
+// @note Only counts when built with the COUNT_ALLOCATIONS CMake option, which replaces the global
+// operator new. Otherwise GetCount() always returns 0. Direct malloc() calls (GLFW, drivers) aren't seen.
+class AllocationCounter
+{
+public:
+    static constexpr unsigned long WARMUP_FRAMES = 60;
+
+    static unsigned long GetCount();
+
+    static constexpr bool IsEnabled()
+    {
+#if COUNT_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+#endif /* ALLOCATION_COUNTER_HPP */
@@ -0,0 +1,43 @@
+#ifndef BOUNDS_HPP
+#define BOUNDS_HPP
+
+#include <glm/glm.hpp>
+
+// @brief Axis-aligned box around a mesh, in the space of its vertices.
+struct BoundingBox
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// @brief Sphere around a mesh, in the space of its vertices.
+struct BoundingSphere
+{
+    glm::vec3 center;
+    float radius;
+
+    static BoundingSphere FromBox(const float min[3], const float max[3]);
+    static BoundingSphere FromBox(const BoundingBox &box);
+    BoundingSphere Transform(const glm::mat4 &model) const;
+};
+
+// @brief The 6 planes bounding what a camera sees, pointing inwards: (normal, distance) with normalized normals.
+struct Frustum
+{
+    glm::vec4 planes[6];
+
+    static Frustum FromMatrix(const glm::mat4 &viewProjection);
+
+    // @return false if the sphere is entirely outside of one plane.
+    bool Intersects(const glm::vec3 &center, float radius) const
+    {
+        for (const glm::vec4 &plane: planes)
+        {
+            if (plane.x*center.x + plane.y*center.y + plane.z*center.z + plane.w < -radius)
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif /* BOUNDS_HPP */
@@ -6,8 +6,14 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <array>
+#include <cstdint>
+
+#include "bounds.hpp"
 
 // @brief This class handles the view/camera coordinate system space.
+// @note The matrices are only rebuilt when the position, target, fov or aspect change: each change bumps the
+// version, and the products of the matrices (view-projection, its inverse, the frustum) are computed at most
+// once per version, on first use. Callers can compare GetVersion() to skip their own per-camera work.
 class Camera
 {
     static constexpr float MAX_ANGLE = 80.0f;
@@ -33,16 +39,25 @@ private:
 
     glm::mat4 m_view;
     glm::mat4 m_perspective;
+    bool m_viewDirty {true};
+    std::uint64_t m_version {0};
+
+    // Derived from m_view and m_perspective, valid for m_cacheVersion
+    mutable glm::mat4 m_viewProjection;
+    mutable glm::mat4 m_inverseViewProjection;
+    mutable Frustum m_frustum;
+    mutable std::uint64_t m_cacheVersion {~std::uint64_t(0)};
 
     void __SetBase();
+    void __UpdateCache() const;
 
 public:
 
     glm::vec3 y = glm::vec3(0.0f, 1.0f, 0.0f);
 
-    Camera(glm::vec3 &initialPosition,
-           glm::vec3 &initialTarget,
-           glm::vec3 &y = glm::vec3(0.0f, 1.0f, 0.0f),
+    Camera(const glm::vec3 &initialPosition,
+           const glm::vec3 &initialTarget,
+           const glm::vec3 &y = glm::vec3(0.0f, 1.0f, 0.0f),
            float speed = 1.0f,
            float rotationSpeed = 0.1f);
 
@@ -75,6 +90,34 @@ public:
         return m_perspective;
     }
 
+    // @brief Changes each time the view or the perspective matrix changes.
+    std::uint64_t
+    GetVersion() const
+    {
+        return m_version;
+    }
+
+    const glm::mat4&
+    GetViewProjection() const
+    {
+        __UpdateCache();
+        return m_viewProjection;
+    }
+
+    const glm::mat4&
+    GetInverseViewProjection() const
+    {
+        __UpdateCache();
+        return m_inverseViewProjection;
+    }
+
+    const Frustum&
+    GetFrustum() const
+    {
+        __UpdateCache();
+        return m_frustum;
+    }
+
     const glm::vec3&
     GetTarget() const
     {
@@ -0,0 +1,51 @@
+#ifndef COMPONENTS_HPP
+#define COMPONENTS_HPP
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+class ItemBuffer;
+
+// Components of the World's entities: plain data, the systems (see Packet) hold the logic.
+
+// @brief Pose of an entity, model is rebuilt from the other members by UpdateModel().
+struct Transform
+{
+    glm::vec3 position;
+    float rotationAngle;    // In radians
+    glm::vec3 rotationAxis;
+    glm::vec3 scale;
+    glm::mat4 model;
+
+    void UpdateModel()
+    {
+        model = glm::translate(glm::mat4(1.0f), position);
+        model = glm::rotate(model, rotationAngle, rotationAxis);
+        model = glm::scale(model, scale);
+    }
+};
+
+// @brief What the renderer draws: a shared mesh and a layer of the board texture array (-1 keeps the mesh's).
+struct Renderable
+{
+    ItemBuffer *mesh;
+    int material;
+    int lod;                // Level of detail of the mesh drawn last frame, see ItemBuffer::SelectLod()
+    bool occluder;          // The mesh fills its bounding box and may hide others, see Table::Mesh
+};
+
+struct RigidBody
+{
+    glm::vec3 velocity;
+    float mass;
+    float restitution;      // Ratio of the speed kept after a bounce, in [0, 1]
+    float friction;
+};
+
+// @brief Bounding sphere around the entity's position.
+struct Collider
+{
+    float radius;
+};
+
+#endif /* COMPONENTS_HPP */
@@ -0,0 +1,100 @@
+#ifndef DYNAMIC_RESOLUTION_HPP
+#define DYNAMIC_RESOLUTION_HPP
+
+#if WINDOWS_MSVC
+#include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
+
+#include <algorithm>
+
+#include "shader.hpp"
+#include "gpuHandle.hpp"
+
+// @brief Renders the scene offscreen at a resolution that follows the GPU's frame time, then upscales it to the window.
+// @note The scene's textures are allocated once at the largest scale: a smaller scale only renders to a corner
+// of them, so changing it costs nothing. The GPU time of the scene is read from timer queries a few frames
+// late, never waiting for the GPU.
+// @note The scale applies to both axes: the aspect ratio, hence the camera, is unchanged.
+class DynamicResolution
+{
+public:
+    enum class Upscale
+    {
+        Bilinear,
+        Sharpen
+    };
+
+    // Frames in flight before a timer query is read back
+    static constexpr int QUERY_COUNT = 4;
+    // Share of the frame budget the scene may use, the rest is left to the upscale and the driver
+    static constexpr double HEADROOM = 0.9;
+    // The scale grows by this ratio while the scene is well under budget, it shrinks at once when over it
+    static constexpr float GROW_STEP = 0.02f;
+    static constexpr double GROW_THRESHOLD = 0.75;
+
+private:
+    int m_width {0};           // Of the window
+    int m_height {0};
+    float m_minScale {0.5f};
+    float m_maxScale {1.0f};
+    float m_scale {1.0f};
+    float m_sharpness {0.0f};
+    double m_targetFrameTime {1.0/144.0};
+    double m_gpuTime {0.0};
+    Texture m_color;
+    Texture m_depth;
+    Framebuffer m_scene;
+    Query m_queries[QUERY_COUNT];
+    bool m_queryPending[QUERY_COUNT] {};
+    int m_frame {0};
+    bool m_measuring {false};
+    VertexArray m_emptyArray;
+    Shader m_upscale;
+
+    void __Allocate();
+    void __ReadQueries();
+    void __Adjust(double gpuTime);
+
+public:
+    DynamicResolution() {}
+    ~DynamicResolution();
+    DynamicResolution(const DynamicResolution &) = delete;
+    DynamicResolution &operator=(const DynamicResolution &) = delete;
+
+    void Create(int width, int height, float minScale, float maxScale, double targetFrameTime);
+    void Resize(int width, int height);
+    void SetUpscale(Upscale filter, float sharpness = 0.5f);
+    void Begin();
+    void End();
+
+    float GetScale() const
+    {
+        return m_scale;
+    }
+    int GetRenderWidth() const
+    {
+        return std::max(static_cast<int>(m_scale*m_width + 0.5f), 1);
+    }
+    int GetRenderHeight() const
+    {
+        return std::max(static_cast<int>(m_scale*m_height + 0.5f), 1);
+    }
+    // @brief Of the scene, as measured by the last timer query read back, in seconds.
+    double GetGpuTime() const
+    {
+        return m_gpuTime;
+    }
+    // @brief The upscaling program, for hot reloading.
+    Shader &GetShader()
+    {
+        return m_upscale;
+    }
+    bool IsCreated() const
+    {
+        return static_cast<bool>(m_scene);
+    }
+};
+
+#endif /* DYNAMIC_RESOLUTION_HPP */
@@ -4,7 +4,10 @@
 #include "itemBuffer.hpp"
 #include "shader.hpp"
 
-class Entity : public ItemBuffer
+// @brief One object of the board: a pose drawn with a shared mesh.
+// @note Only points to its ItemBuffer, owned elsewhere (see ResourceRegistry): copying or relocating
+// entities never touches the driver.
+class Entity
 {
 private:
     ItemBuffer *m_buffer;
@@ -15,21 +18,25 @@ private:
     float m_rotationAngle;
     glm::vec3 m_scaleFactor;
     glm::mat4 m_model;
+    int m_material {-1};
+    float m_mass {0.0f};
+    float m_restitution {0.0f};
+    float m_friction {0.0f};
     
 public:
     // Entity(ItemBuffer *buffer, glm::vec3 &translationAxis = glm::vec3(0.0f), glm::vec3 &rotationAxis = glm::vec3(0.0f));
     Entity(ItemBuffer *buffer,
-           glm::vec3 &translationAxis = glm::vec3(0.0f),
-           glm::vec3 &rotationAxis = glm::vec3(0.0f),
+           const glm::vec3 &translationAxis = glm::vec3(0.0f),
+           const glm::vec3 &rotationAxis = glm::vec3(0.0f),
            float rotationAngle = 0.0f,
-           glm::vec3 &scaleFactor = glm::vec3(1.0f));
+           const glm::vec3 &scaleFactor = glm::vec3(1.0f));
     ~Entity() = default;
 
     float x;
     float y;
     float z;
 
-    void Draw(int count);
+    void Draw(int count = 0, bool bind = true);
     void Paint();
     void ChangeModel(const glm::mat4 &model);
     void UpdateModel(const glm::vec3 &translationAxis, const glm::vec3 &rotationAxis, float rotationAngle, const glm::vec3 &scaleFactor);
@@ -40,7 +47,51 @@ public:
     bool IsReachable(double x_mouse, double y_mouse, float z_camera);
 
     void Expulse(float timeFrame, glm::vec3 direction);
+    void SetPhysics(float mass, float restitution, float friction);
 
+    // @brief Layer of the board texture array drawn on the entity, -1 keeps the layer of its vertices.
+    void SetMaterial(int layer)
+    {
+        m_material = layer;
+    }
+    int GetMaterial() const
+    {
+        return m_material;
+    }
+    float GetMass() const
+    {
+        return m_mass;
+    }
+    float GetRestitution() const
+    {
+        return m_restitution;
+    }
+    float GetFriction() const
+    {
+        return m_friction;
+    }
+
+    const glm::vec3 &GetOrigin() const
+    {
+        return m_origin;
+    }
+    const glm::vec3 &GetRotationAxis() const
+    {
+        return m_rotationAxis;
+    }
+    // @return The angle in degrees, as given to the constructor.
+    float GetRotationAngle() const
+    {
+        return m_rotationAngle;
+    }
+    const glm::vec3 &GetScale() const
+    {
+        return m_scaleFactor;
+    }
+    ItemBuffer *GetBuffer() const
+    {
+        return m_buffer;
+    }
     unsigned int GetBoundary() const
     {
         return m_boundary;
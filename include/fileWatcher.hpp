@@ -0,0 +1,52 @@
+#ifndef FILE_WATCHER_HPP
+#define FILE_WATCHER_HPP
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// @brief Reports the files written in a few folders since the last Poll(), for hot reloading.
+// @note Uses inotify on Linux: Poll() reads the events queued since its last call and never blocks.
+// On Windows a change notification per folder tells when to scan it for newer modification times:
+// folders nobody writes to are never scanned.
+// @note Not copyable: the inotify descriptor and the notifications are closed when the owner goes out of scope.
+class FileWatcher
+{
+public:
+    // A file written since the last Poll()
+    struct Change
+    {
+        int folder;         // As returned by Watch()
+        std::string file;   // Name within that folder
+    };
+
+private:
+    std::vector<std::string> m_folders;
+    #if WINDOWS_MSVC
+    // Last modification time of every file of each folder
+    std::vector<std::unordered_map<std::string, std::filesystem::file_time_type>> m_times;
+    std::vector<void *> m_notifications; // One change notification HANDLE per folder
+    #else
+    int m_inotify {-1};
+    std::vector<int> m_watches; // One per folder
+    #endif
+
+    void __AddChange(std::vector<Change> &changes, int folder, const char *file) const;
+
+public:
+    FileWatcher() {}
+    ~FileWatcher();
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    int Watch(const std::string &folder);
+    bool Poll(std::vector<Change> &changes);
+
+    const std::string &GetFolder(int folder) const
+    {
+        return m_folders[folder];
+    }
+};
+
+#endif /* FILE_WATCHER_HPP */
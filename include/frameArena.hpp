@@ -0,0 +1,111 @@
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// @brief Linear allocator for the scratch data of one frame: render queues, culling results, contact pairs...
+// @note Allocating bumps an offset in a single block, nothing is freed until Reset() rewinds the whole arena
+// at the end of the frame. Requests past the block are served by the heap and the block grows at the next
+// Reset() to the frame's peak, so a steady frame never touches the heap.
+// @note Also a std::pmr::memory_resource: std::pmr containers can live in the arena. Their growth leaves the
+// old storage behind until Reset(), reserve() them up front.
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 20;
+
+private:
+    // Heap allocations past the block, chained to be freed at Reset()
+    struct Overflow
+    {
+        Overflow *next;
+    };
+
+    unsigned char *m_block {nullptr};
+    size_t m_capacity;
+    size_t m_used {0};
+    size_t m_peak {0};
+    size_t m_overflowSize {0};
+    Overflow *m_overflow {nullptr};
+
+    void *__AllocateOverflow(size_t bytes, size_t alignment);
+
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        return Allocate(bytes, alignment);
+    }
+    void do_deallocate(void *, size_t, size_t) override
+    {
+        // Released all at once by Reset()
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+public:
+    // @param capacity In bytes, the initial size of the block.
+    FrameArena(size_t capacity = DEFAULT_CAPACITY);
+    ~FrameArena();
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void Reset();
+
+    // @brief Raw, uninitialized memory valid until the next Reset().
+    // @param alignment A power of two, of any size: the address itself is aligned, not its offset in the block.
+    void *Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+    {
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(m_block);
+        size_t offset = ((base + m_used + alignment-1) & ~(alignment-1)) - base;
+        if (offset > m_capacity || bytes > m_capacity - offset)
+            return __AllocateOverflow(bytes, alignment);
+        m_used = offset + bytes;
+        return m_block + offset;
+    }
+
+    // @brief An array of default-initialized T, valid until the next Reset().
+    // @note Destructors are never called: T must be trivially destructible.
+    template<typename T>
+    T *Allocate(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "The frame arena never calls destructors");
+        if (count > std::numeric_limits<size_t>::max()/sizeof(T))
+            throw std::bad_array_new_length();
+        T *items = static_cast<T *>(Allocate(count*sizeof(T), alignof(T)));
+        std::uninitialized_default_construct_n(items, count);
+        return items;
+    }
+
+    // @brief One T built from the given arguments, valid until the next Reset().
+    template<typename T, typename... Args>
+    T *New(Args &&...args)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "The frame arena never calls destructors");
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // @brief In bytes, what the current frame allocated so far, heap overflows included.
+    size_t GetUsed() const
+    {
+        return m_used + m_overflowSize;
+    }
+    // @brief In bytes, the most a frame allocated since the arena was created.
+    size_t GetPeak() const
+    {
+        return m_peak > GetUsed() ? m_peak : GetUsed();
+    }
+    size_t GetCapacity() const
+    {
+        return m_capacity;
+    }
+};
+
+#endif /* FRAME_ARENA_HPP */
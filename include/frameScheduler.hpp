@@ -0,0 +1,87 @@
+#ifndef FRAME_SCHEDULER_HPP
+#define FRAME_SCHEDULER_HPP
+
+#if WINDOWS_MSVC
+#include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
+#include <GLFW/glfw3.h> // After the loader, which must come before the system OpenGL headers
+
+// @brief Paces the main loop: when a frame starts, when it is presented, and how long it took.
+// @note BeginFrame() comes before sampling the input, EndFrame() presents the frame.
+// In LowLatency mode, BeginFrame() sleeps until just before the predicted vblank minus the time a frame takes,
+// so that the input is sampled as late as possible instead of right after the previous swap.
+class FrameScheduler
+{
+public:
+    enum class Mode
+    {
+        Uncapped,       // No vsync: as many frames as possible, tearing
+        VSync,          // Every frame waits for a vblank
+        AdaptiveVSync,  // Late frames are presented right away and tear instead of waiting a whole refresh
+        LowLatency      // VSync, starting each frame as late as its predicted cost allows
+    };
+
+    // Woken up this early before the predicted start of a frame, the OS sleep is not more precise
+    static constexpr double SLEEP_MARGIN = 0.002;
+    // Extra room left to the frame on top of its predicted cost
+    static constexpr double SAFETY_MARGIN = 0.001;
+
+    // @brief Frame-time statistics since the first frame (Welford's running variance).
+    struct Stats
+    {
+        unsigned long count {0};
+        double mean {0.0};
+        double m2 {0.0};
+        double min {0.0};
+        double max {0.0};
+
+        void Add(double frameTime);
+        double GetVariance() const
+        {
+            return count > 1 ? m2 / (count-1) : 0.0;
+        }
+    };
+
+private:
+    GLFWwindow *m_window {nullptr};
+    Mode m_mode {Mode::VSync};
+    double m_refreshPeriod {1.0/60.0};
+    double m_frameStart {0.0};
+    double m_lastFrameStart {0.0};
+    double m_lastPresent {0.0};
+    double m_workEstimate {0.0};  // Time from the start of a frame to its swap, GPU included in LowLatency mode
+    float m_deltaTime {0.0f};
+    Stats m_stats;
+
+    void __SleepUntil(double time) const;
+
+public:
+    FrameScheduler() {}
+    ~FrameScheduler() = default;
+
+    Mode Setup(GLFWwindow *window, Mode mode);
+    void BeginFrame();
+    void EndFrame();
+
+    // @brief Time between the starts of the last two frames, in seconds.
+    float GetDeltaTime() const
+    {
+        return m_deltaTime;
+    }
+    Mode GetMode() const
+    {
+        return m_mode;
+    }
+    double GetRefreshPeriod() const
+    {
+        return m_refreshPeriod;
+    }
+    const Stats &GetStats() const
+    {
+        return m_stats;
+    }
+};
+
+#endif /* FRAME_SCHEDULER_HPP */
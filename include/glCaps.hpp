@@ -0,0 +1,70 @@
+#ifndef GL_CAPS_HPP
+#define GL_CAPS_HPP
+
+#if WINDOWS_MSVC
+#include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
+
+// KHR_parallel_shader_compile is not in the 4.4 core loader, only its query is used (see Shader::IsVariantReady())
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// @brief What the current context supports beyond the 3.3 core profile main.cpp asks for.
+// @note Drivers usually hand out their latest version for a 3.3 core request, so the newer paths are
+// picked at runtime: a feature is there if the context's version has it in core, or if it exposes the extension.
+class GLCaps
+{
+private:
+    static inline int s_major {0};
+    static inline int s_minor {0};
+    static inline bool s_parallelShaderCompile {false};
+    static inline bool s_textureCompressionS3TC {false};
+
+public:
+    // @brief Reads the context's version, once it is current and the loader is initialized.
+    static void Load();
+
+    static bool HasVersion(int major, int minor)
+    {
+        return s_major > major || (s_major == major && s_minor >= minor);
+    }
+    static bool HasExtension(const char *name);
+
+    // glMultiDrawElementsIndirect() with per-draw baseInstance, and a loader that found the entry point
+    static bool HasMultiDrawIndirect()
+    {
+        bool supported = HasVersion(4, 3) || (HasExtension("GL_ARB_multi_draw_indirect") && HasExtension("GL_ARB_base_instance"));
+        return supported && glMultiDrawElementsIndirect != nullptr;
+    }
+    // glGetProgramBinary() and glProgramBinary(), with at least one binary format (see ShaderCache)
+    static bool HasProgramBinary()
+    {
+        bool supported = HasVersion(4, 1) || HasExtension("GL_ARB_get_program_binary");
+        GLint formats = 0;
+        if (supported)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0 && glProgramBinary != nullptr;
+    }
+    // GL_COMPLETION_STATUS_KHR: whether a compile or link is done can be asked without waiting for it.
+    // Read once by Load(), it's polled for every program being built
+    static bool HasParallelShaderCompile()
+    {
+        return s_parallelShaderCompile;
+    }
+    // BC1 (DXT1) textures can be uploaded as they are (see TextureCache).
+    // Read once by Load(): asked from the loader's threads, which can't call GL
+    static bool HasTextureCompressionS3TC()
+    {
+        return s_textureCompressionS3TC;
+    }
+    // Compute shaders and shader storage buffers
+    static bool HasComputeShaders()
+    {
+        return HasVersion(4, 3) && glDispatchCompute != nullptr;
+    }
+};
+
+#endif /* GL_CAPS_HPP */
@@ -0,0 +1,86 @@
+#ifndef GPU_CULLER_HPP
+#define GPU_CULLER_HPP
+
+#if WINDOWS_MSVC
+#include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "shader.hpp"
+#include "gpuHandle.hpp"
+#include "bounds.hpp"
+#include "meshPool.hpp"
+
+// @brief Culls the pooled entities on the GPU: a compute shader tests every entity against the frustum (and the
+// depth pyramid of this frame's occluders, built just before, if any) and writes the visible ones straight into the MeshPool's instance and
+// indirect command buffers. The CPU never learns what was culled: the draws are issued as is.
+// @note GL 4.3 only (compute shaders, SSBOs and multi-draw indirect), see GLCaps.
+class GpuCuller
+{
+public:
+    static constexpr unsigned int GROUP_SIZE = 64;
+    // Visible counts on their way back at once: the GPU may run this many frames behind before one goes unread
+    static constexpr int READBACK_COUNT = 4;
+
+    // An entity to test, in the std430 layout of cullInstances.cs
+    struct Object
+    {
+        float model[16];
+        float sphere[4];     // Center and radius, in the mesh's space
+        GLuint command;      // Index of its mesh's DrawElementsIndirectCommand
+        GLint material;
+        GLuint padding[2];
+    };
+
+private:
+    Shader m_program;
+    Buffer m_objects;
+    size_t m_objectCapacity {0};
+    unsigned int m_hiZ {0};
+    glm::vec2 m_hiZSize {0.0f};
+    int m_hiZLevels {0};
+
+    // A copy of the commands a Cull() wrote, read once the GPU signals its fence, see QueueVisibleCount()
+    struct Readback
+    {
+        Buffer buffer;
+        size_t capacity {0};
+        GLsync fence {nullptr};
+        size_t commandCount {0};
+        size_t testedCount {0};
+    };
+    Readback m_readbacks[READBACK_COUNT];
+    int m_nextReadback {0};
+    std::vector<MeshPool::DrawElementsIndirectCommand> m_readback; // Reused by ReadVisibleCount()
+
+public:
+    GpuCuller() {}
+    ~GpuCuller();
+    GpuCuller(const GpuCuller &) = delete;
+    GpuCuller &operator=(const GpuCuller &) = delete;
+
+    void Create();
+    void SetHiZ(unsigned int texture, int width, int height, int levels);
+    void Cull(const Object *objects, size_t count, const Frustum &frustum, const glm::mat4 &viewProjection, MeshPool &pool);
+    bool QueueVisibleCount(MeshPool &pool, size_t commandCount, size_t testedCount);
+    bool ReadVisibleCount(size_t &visibleCount, size_t &testedCount);
+
+    // @brief The culling program, for hot reloading.
+    Shader &GetShader()
+    {
+        return m_program;
+    }
+
+    bool IsCreated() const
+    {
+        return static_cast<bool>(m_objects);
+    }
+};
+
+#endif /* GPU_CULLER_HPP */
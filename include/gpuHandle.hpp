@@ -0,0 +1,144 @@
+#ifndef GPU_HANDLE_HPP
+#define GPU_HANDLE_HPP
+
+#if WINDOWS_MSVC
+#include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
+
+#include <utility>
+
+// @brief Owns one OpenGL object name and deletes it along with the handle.
+// @note Move-only: a name has exactly one owner, moved-from handles hold 0 and delete nothing.
+// Objects sharing a GPU resource keep a pointer to its owner instead (see ResourceRegistry).
+template<typename Traits>
+class GpuHandle
+{
+private:
+    unsigned int m_id {0};
+
+public:
+    GpuHandle() {}
+    explicit GpuHandle(unsigned int id) :
+        m_id {id}
+    {
+    }
+    ~GpuHandle()
+    {
+        Reset();
+    }
+    GpuHandle(const GpuHandle &) = delete;
+    GpuHandle &operator=(const GpuHandle &) = delete;
+    GpuHandle(GpuHandle &&other) noexcept :
+        m_id {std::exchange(other.m_id, 0)}
+    {
+    }
+    GpuHandle &operator=(GpuHandle &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            m_id = std::exchange(other.m_id, 0);
+        }
+        return *this;
+    }
+
+    // @brief Generates a new object name.
+    static GpuHandle Create()
+    {
+        unsigned int id = 0;
+        Traits::Generate(1, &id);
+        return GpuHandle(id);
+    }
+
+    // @brief Deletes the object, the handle holds 0 afterwards.
+    void Reset()
+    {
+        if (m_id)
+            Traits::Delete(1, &m_id);
+        m_id = 0;
+    }
+    // @brief Gives up the ownership without deleting the object.
+    unsigned int Release()
+    {
+        return std::exchange(m_id, 0);
+    }
+
+    unsigned int Get() const
+    {
+        return m_id;
+    }
+    explicit operator bool() const
+    {
+        return m_id != 0;
+    }
+};
+
+struct VertexArrayTraits
+{
+    static void Generate(GLsizei count, unsigned int *ids)
+    {
+        glGenVertexArrays(count, ids);
+    }
+    static void Delete(GLsizei count, const unsigned int *ids)
+    {
+        glDeleteVertexArrays(count, ids);
+    }
+};
+
+struct BufferTraits
+{
+    static void Generate(GLsizei count, unsigned int *ids)
+    {
+        glGenBuffers(count, ids);
+    }
+    static void Delete(GLsizei count, const unsigned int *ids)
+    {
+        glDeleteBuffers(count, ids);
+    }
+};
+
+struct TextureTraits
+{
+    static void Generate(GLsizei count, unsigned int *ids)
+    {
+        glGenTextures(count, ids);
+    }
+    static void Delete(GLsizei count, const unsigned int *ids)
+    {
+        glDeleteTextures(count, ids);
+    }
+};
+
+struct FramebufferTraits
+{
+    static void Generate(GLsizei count, unsigned int *ids)
+    {
+        glGenFramebuffers(count, ids);
+    }
+    static void Delete(GLsizei count, const unsigned int *ids)
+    {
+        glDeleteFramebuffers(count, ids);
+    }
+};
+
+struct QueryTraits
+{
+    static void Generate(GLsizei count, unsigned int *ids)
+    {
+        glGenQueries(count, ids);
+    }
+    static void Delete(GLsizei count, const unsigned int *ids)
+    {
+        glDeleteQueries(count, ids);
+    }
+};
+
+using VertexArray = GpuHandle<VertexArrayTraits>;
+using Buffer = GpuHandle<BufferTraits>;
+using Texture = GpuHandle<TextureTraits>;
+using Framebuffer = GpuHandle<FramebufferTraits>;
+using Query = GpuHandle<QueryTraits>;
+
+#endif /* GPU_HANDLE_HPP */
@@ -0,0 +1,22 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// @brief 64-bit FNV-1a hash, used to key the on-disk caches.
+// @param seed Chains hashes: pass the hash of the previous block to hash several blocks as one.
+inline std::uint64_t
+Hash64(const void *data, std::size_t size, std::uint64_t seed = 14695981039346656037ull)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    std::uint64_t hash = seed;
+    for (std::size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+#endif /* HASH_HPP */
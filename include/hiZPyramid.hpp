@@ -0,0 +1,68 @@
+#ifndef HI_Z_PYRAMID_HPP
+#define HI_Z_PYRAMID_HPP
+
+#if WINDOWS_MSVC
+#include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
+
+#include <vector>
+
+#include "shader.hpp"
+#include "gpuHandle.hpp"
+
+// @brief Hierarchical depth buffer for occlusion culling on the GPU.
+// @note The large occluders are drawn in a depth-only prepass, then each mip level of a R32F texture keeps the
+// farthest depth of the 2x2 texels below it. An entity whose nearest depth is behind the pyramid's texels
+// covering its screen rectangle is hidden (see cullInstances.cs).
+// @note GL 3.3 is enough to build it, testing against it needs the GPU culler.
+class HiZPyramid
+{
+private:
+    int m_width {0};
+    int m_height {0};
+    int m_levels {0};
+    Texture m_depth;
+    Texture m_pyramid;
+    Framebuffer m_prepass;
+    std::vector<Framebuffer> m_levelTargets;
+    VertexArray m_emptyArray; // The core profile draws nothing without a Vertex Array
+    Shader m_downsample;
+    GLint m_viewport[4];
+    GLint m_framebuffer {0};  // Bound before the prepass, the window's or the scene's (see DynamicResolution)
+
+public:
+    HiZPyramid() {}
+    ~HiZPyramid();
+    HiZPyramid(const HiZPyramid &) = delete;
+    HiZPyramid &operator=(const HiZPyramid &) = delete;
+
+    void Create(int width, int height);
+    void BeginPrepass();
+    void Build();
+
+    unsigned int GetTexture() const
+    {
+        return m_pyramid.Get();
+    }
+    int GetWidth() const
+    {
+        return m_width;
+    }
+    int GetHeight() const
+    {
+        return m_height;
+    }
+    int GetLevelCount() const
+    {
+        return m_levels;
+    }
+    // @brief The downsampling program, for hot reloading.
+    Shader &GetShader()
+    {
+        return m_downsample;
+    }
+};
+
+#endif /* HI_Z_PYRAMID_HPP */
@@ -13,22 +13,61 @@
 
 #include <vector>
 #include <string>
+#include <future>
+
+#include "textureLoader.hpp"
+#include "vertexLayout.hpp"
+#include "meshFile.hpp"
+#include "gpuHandle.hpp"
+#include "bounds.hpp"
 
 class ItemBuffer
 {
     static constexpr int MAX_ACTIVE_TEXTURE = 16;
 
+public:
+    // Screen size under which the first simplified level of a mesh file is drawn, halved at each next level
+    static constexpr float LOD_SCREEN_SIZE = 0.25f;
+
+    // @brief A level of detail: a range of the indices, drawn while the mesh covers at least screenSize of the
+    // viewport's height. Level 0 is the full mesh, each next one is coarser with a smaller screenSize.
+    struct Lod
+    {
+        int firstIndex;
+        int indexCount;
+        float screenSize;
+    };
+
 private:
-    unsigned int m_VA0;
-    unsigned int m_EB0;
-    unsigned int m_VBO;
-    void *m_buffer;
-    std::vector<unsigned int> m_textures;
+    VertexArray m_VA0;
+    Buffer m_EB0;
+    Buffer m_VBO;
+    const void *m_buffer {nullptr};
+    int m_size {0};
+    int m_vertexCount {0};
+    int m_indexCount {0};
+    GLenum m_indexType {GL_UNSIGNED_INT};
+    std::vector<Buffer> m_streamVBOs; // Streams after the first one, see VertexLayout
+    std::vector<Texture> m_textures;
+    BoundingBox m_bounds {glm::vec3(0.0f), glm::vec3(0.0f)};
+    bool m_hasBounds {false};
+    std::vector<Lod> m_lods;
+
+    void __CreateStreams(const VertexLayout &layout, const unsigned char *const *streams, const size_t *sizes);
+    void __AddIndices(const void *indices, int sizeIndices);
 
 public:
     ItemBuffer() {}
-    ItemBuffer(void *vertexBuffer, int size, unsigned int *indices = nullptr, int sizeIndices = 0);
-    ~ItemBuffer();
+    ItemBuffer(const void *vertexBuffer, int size, const void *indices = nullptr, int sizeIndices = 0, GLenum indexType = GL_UNSIGNED_INT);
+    ItemBuffer(const VertexLayout &layout, const std::vector<std::vector<unsigned char>> &streams,
+               const void *indices = nullptr, int sizeIndices = 0, GLenum indexType = GL_UNSIGNED_INT);
+    ItemBuffer(const MeshFile &mesh);
+    ~ItemBuffer() = default;
+    // Owns its GPU objects: moved, never copied
+    ItemBuffer(const ItemBuffer &) = delete;
+    ItemBuffer &operator=(const ItemBuffer &) = delete;
+    ItemBuffer(ItemBuffer &&) = default;
+    ItemBuffer &operator=(ItemBuffer &&) = default;
 
     void AddVertexAttrib(unsigned int index, unsigned int count, unsigned int stride, unsigned int offset);
     void AddPositionAttrib(int stride);
@@ -36,9 +75,54 @@ public:
     void AddTextureAttrib(int stride);
 
     void AddTexture2D(unsigned int &id, const std::string &img, int wrappingParam = GL_REPEAT, int filteringParam = GL_LINEAR);
+    std::shared_future<bool> AddTexture2DAsync(TextureLoader &loader, unsigned int &id, const std::string &img, int wrappingParam = GL_REPEAT, int filteringParam = GL_LINEAR);
     void BindTextures();
 
     void Bind();
+    void Draw(int count = 0);
+    void DrawLod(int lod);
+
+    void AddLod(int firstIndex, int indexCount, float screenSize);
+    int SelectLod(float screenSize, int current, float hysteresis) const;
+
+    // @brief Box around the vertices, for culling. Read from the file of a MeshFile, to be given otherwise.
+    void SetBounds(const BoundingBox &bounds)
+    {
+        m_bounds = bounds;
+        m_hasBounds = true;
+    }
+    // @return nullptr if the bounds are unknown: the mesh is then never culled.
+    const BoundingBox *GetBounds() const
+    {
+        return m_hasBounds ? &m_bounds : nullptr;
+    }
+    // @brief 1 for a mesh without simplified levels.
+    int GetLodCount() const
+    {
+        return m_lods.empty() ? 1 : static_cast<int>(m_lods.size());
+    }
+    // @note Level 0 of a mesh without simplified levels is the whole index buffer.
+    Lod GetLod(int lod) const
+    {
+        return m_lods.empty() ? Lod {0, m_indexCount, 0.0f} : m_lods[lod];
+    }
+    bool IsIndexed() const
+    {
+        return static_cast<bool>(m_EB0);
+    }
+    // @brief Number of vertices, known once an attribute gave the stride.
+    int GetVertexCount() const
+    {
+        return m_vertexCount;
+    }
+    int GetIndexCount() const
+    {
+        return m_indexCount;
+    }
+    GLenum GetIndexType() const
+    {
+        return m_indexType;
+    }
 };
 
 
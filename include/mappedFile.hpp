@@ -0,0 +1,46 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// @brief Read-only memory mapping of a whole file.
+// @note Move-only: the mapping is released when the owner goes out of scope.
+class MappedFile
+{
+private:
+    const unsigned char *m_data {nullptr};
+    std::size_t m_size {0};
+    #if WINDOWS_MSVC
+    void *m_file {nullptr};
+    void *m_mapping {nullptr};
+    #else
+    int m_file {-1};
+    #endif
+
+public:
+    MappedFile() {}
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    bool Open(const std::string &path);
+    void Close();
+
+    bool IsOpen() const
+    {
+        return m_data != nullptr;
+    }
+    const unsigned char *GetData() const
+    {
+        return m_data;
+    }
+    std::size_t GetSize() const
+    {
+        return m_size;
+    }
+};
+
+#endif /* MAPPED_FILE_HPP */
@@ -0,0 +1,65 @@
+#ifndef MESH_BUILDER_HPP
+#define MESH_BUILDER_HPP
+
+#include <cstddef>
+#include <vector>
+
+// @brief Turns an unindexed triangle list into indexed geometry for ItemBuffer.
+// @note Identical vertices are merged, triangles are reordered for the post-transform vertex cache
+// (Tom Forsyth's linear-speed algorithm) and vertices are reordered by first use for fetch locality.
+class MeshBuilder
+{
+public:
+    static constexpr unsigned int CACHE_SIZE = 32;
+
+private:
+    unsigned int m_stride;
+    size_t m_inputVertexCount;
+    std::vector<float> m_vertices;
+    std::vector<unsigned int> m_indices;
+
+    void __ReorderVertices();
+
+public:
+    // @param vertices Interleaved float attributes of a triangle list.
+    // @param stride In floats, the size of one vertex.
+    MeshBuilder(const float *vertices, size_t vertexCount, unsigned int stride);
+    ~MeshBuilder() = default;
+
+    void Optimize(unsigned int cacheSize = CACHE_SIZE);
+
+    static float ComputeACMR(const unsigned int *indices, size_t indexCount, unsigned int cacheSize = CACHE_SIZE);
+    static unsigned int CountTransforms(const unsigned int *indices, size_t indexCount, unsigned int cacheSize = CACHE_SIZE);
+
+    // @brief True when the indices don't fit in GL_UNSIGNED_SHORT.
+    bool NeedsWideIndices() const
+    {
+        return GetVertexCount() > 0xFFFF;
+    }
+    std::vector<unsigned short> GetIndices16() const
+    {
+        return std::vector<unsigned short>(m_indices.begin(), m_indices.end());
+    }
+    const std::vector<unsigned int> &GetIndices() const
+    {
+        return m_indices;
+    }
+    const std::vector<float> &GetVertices() const
+    {
+        return m_vertices;
+    }
+    size_t GetVertexCount() const
+    {
+        return m_vertices.size()/m_stride;
+    }
+    size_t GetInputVertexCount() const
+    {
+        return m_inputVertexCount;
+    }
+    unsigned int GetStride() const
+    {
+        return m_stride;
+    }
+};
+
+#endif /* MESH_BUILDER_HPP */
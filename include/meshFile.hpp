@@ -0,0 +1,101 @@
+#ifndef MESH_FILE_HPP
+#define MESH_FILE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mappedFile.hpp"
+#include "vertexLayout.hpp"
+
+// @brief Binary mesh asset (.fmesh), loaded by mapping the file and uploading its tables as they are.
+// @note Layout: Header, the attribute table, the submesh table, then the vertices of every stream and the
+// indices, each table starting on a 16-byte boundary. Streams are stored in their GPU format (see VertexLayout)
+// and indices in GL_UNSIGNED_SHORT or GL_UNSIGNED_INT: nothing is converted at load time.
+class MeshFile
+{
+public:
+    static constexpr std::uint32_t MAGIC = 0x48534D46; // "FMSH"
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr unsigned int MAX_STREAMS = 4;
+
+    struct Header
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t vertexCount;
+        std::uint32_t indexCount;
+        std::uint32_t indexType;
+        std::uint32_t attributeCount;
+        std::uint32_t streamCount;
+        std::uint32_t submeshCount;
+        std::uint32_t streamStrides[MAX_STREAMS];
+        std::uint64_t streamOffsets[MAX_STREAMS];
+        std::uint64_t attributeOffset;
+        std::uint64_t submeshOffset;
+        std::uint64_t indexOffset;
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    struct Attribute
+    {
+        std::uint32_t index;
+        std::uint32_t components;
+        std::uint32_t type;
+        std::uint32_t normalized;
+        std::uint32_t stream;
+    };
+
+    // @brief A range of indices drawn with one material.
+    struct Submesh
+    {
+        std::uint32_t firstIndex;
+        std::uint32_t indexCount;
+        std::uint32_t material;
+        std::uint32_t lod;
+    };
+
+private:
+    MappedFile m_file;
+    const Header *m_header {nullptr};
+
+public:
+    MeshFile() {}
+    ~MeshFile() = default;
+
+    bool Open(const std::string &path);
+    VertexLayout GetLayout() const;
+
+    static bool Write(const std::string &path, const VertexLayout &layout,
+                      const std::vector<std::vector<unsigned char>> &streams, size_t vertexCount,
+                      const std::vector<unsigned int> &indices, const std::vector<Submesh> &submeshes,
+                      const float *boundsMin, const float *boundsMax);
+
+    const Header &GetHeader() const
+    {
+        return *m_header;
+    }
+    const unsigned char *GetStreamData(unsigned int stream) const
+    {
+        return m_file.GetData() + m_header->streamOffsets[stream];
+    }
+    size_t GetStreamSize(unsigned int stream) const
+    {
+        return static_cast<size_t>(m_header->vertexCount)*m_header->streamStrides[stream];
+    }
+    const unsigned char *GetIndexData() const
+    {
+        return m_file.GetData() + m_header->indexOffset;
+    }
+    size_t GetIndexSize() const
+    {
+        return static_cast<size_t>(m_header->indexCount)*(m_header->indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+    }
+    const Submesh *GetSubmeshes() const
+    {
+        return reinterpret_cast<const Submesh *>(m_file.GetData() + m_header->submeshOffset);
+    }
+};
+
+#endif /* MESH_FILE_HPP */
@@ -0,0 +1,126 @@
+#ifndef MESH_POOL_HPP
+#define MESH_POOL_HPP
+
+#if WINDOWS_MSVC
+#include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "vertexLayout.hpp"
+#include "meshFile.hpp"
+#include "gpuHandle.hpp"
+#include "bounds.hpp"
+
+class ItemBuffer;
+
+// @brief Packs the static meshes in shared buffers: one Vertex Array, one VBO per stream and one EBO per vertex layout.
+// @note Meshes of the same layout are drawn together by a single glMultiDrawElementsIndirect() (see Packet):
+// each one is a DrawElementsIndirectCommand over its range of the pool, instanced once per entity.
+// Instances read their model matrix and material from the instance buffer, at INSTANCE_LOCATION and after.
+// @note Meshes are added while loading, then Upload() sends everything at once and frees the CPU copies.
+// @note Each level of detail of a mesh (see ItemBuffer::AddLod()) is a range of its own.
+class MeshPool
+{
+public:
+    // Locations of the per-instance attributes: the model matrix takes 4 of them, then the material
+    static constexpr unsigned int INSTANCE_LOCATION = 4;
+
+    // As read by glMultiDrawElementsIndirect() from the GL_DRAW_INDIRECT_BUFFER
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // Padded to the std430 layout, so that the culling compute shader writes them too (see GpuCuller)
+    struct Instance
+    {
+        float model[16];
+        GLint material;
+        GLint padding[3];
+    };
+
+    // Where a mesh lies in the pool
+    struct Range
+    {
+        unsigned int layout;      // Which of the pool's layouts, each has its own buffers
+        unsigned int firstIndex;
+        unsigned int indexCount;
+        int baseVertex;
+        BoundingSphere bounds;    // In the mesh's space
+    };
+
+private:
+    struct LayoutBuffers
+    {
+        VertexLayout layout;
+        std::vector<std::vector<unsigned char>> streams;
+        std::vector<unsigned int> indices;
+        unsigned int vertexCount {0};
+        VertexArray vertexArray;
+        std::vector<Buffer> vertexBuffers;
+        Buffer indexBuffer;
+    };
+
+    std::vector<LayoutBuffers> m_layouts;
+    std::unordered_map<const ItemBuffer *, std::vector<Range>> m_ranges; // One per level of detail of the mesh
+    Buffer m_instanceBuffer;
+    Buffer m_commandBuffer;
+    size_t m_instanceCapacity {0};
+    size_t m_commandCapacity {0};
+
+    void __SetInstancePointers(size_t firstInstance);
+
+public:
+    MeshPool() {}
+    ~MeshPool() = default;
+    MeshPool(const MeshPool &) = delete;
+    MeshPool &operator=(const MeshPool &) = delete;
+
+    bool Add(const ItemBuffer *mesh, const VertexLayout &layout, const unsigned char *const *streams, const size_t *sizes,
+             const void *indices, size_t indexCount, GLenum indexType, const BoundingSphere &bounds);
+    bool Add(const ItemBuffer *mesh, const VertexLayout &layout, const std::vector<std::vector<unsigned char>> &streams,
+             const void *indices, size_t indexCount, GLenum indexType, const BoundingSphere &bounds);
+    bool Add(const ItemBuffer *mesh, const MeshFile &file);
+    void Upload();
+
+    void UploadInstances(const Instance *instances, size_t count);
+    void UploadCommands(const DrawElementsIndirectCommand *commands, size_t count);
+    void ReserveInstances(size_t count);
+    void Bind(unsigned int layout);
+    void MultiDraw(size_t firstCommand, size_t count);
+    void DrawLoop(const DrawElementsIndirectCommand *commands, size_t count);
+
+    // @param lod Level of detail of the mesh, clamped to its coarsest one.
+    // @return nullptr if the mesh was not added to the pool.
+    const Range *Find(const ItemBuffer *mesh, int lod = 0) const
+    {
+        auto it = m_ranges.find(mesh);
+        if (it == m_ranges.end())
+            return nullptr;
+        return &it->second[std::min(static_cast<size_t>(lod), it->second.size()-1)];
+    }
+    unsigned int GetInstanceBuffer() const
+    {
+        return m_instanceBuffer.Get();
+    }
+    unsigned int GetCommandBuffer() const
+    {
+        return m_commandBuffer.Get();
+    }
+    unsigned int GetLayoutCount() const
+    {
+        return static_cast<unsigned int>(m_layouts.size());
+    }
+};
+
+#endif /* MESH_POOL_HPP */
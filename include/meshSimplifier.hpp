@@ -0,0 +1,30 @@
+#ifndef MESH_SIMPLIFIER_HPP
+#define MESH_SIMPLIFIER_HPP
+
+#include <cstddef>
+#include <vector>
+
+// @brief Builds the level-of-detail chain of a mesh offline (see mesh_converter --lods).
+// @note Vertex clustering: vertices are snapped to a grid and every cell keeps one of its own vertices, the
+// one closest to the cell's average. Triangles that collapse are dropped. The simplified indices point into
+// the original vertices, so every level shares the vertex buffer of the mesh and only adds indices.
+// @note The grid ignores texture seams and normals: good enough for what is only seen from afar.
+class MeshSimplifier
+{
+private:
+    const float *m_vertices;
+    size_t m_vertexCount;
+    unsigned int m_stride;
+    float m_extent;          // Largest side of the bounding box
+
+public:
+    // @param vertices Interleaved float attributes, the position first.
+    // @param stride In floats, the size of one vertex.
+    MeshSimplifier(const float *vertices, size_t vertexCount, unsigned int stride);
+    ~MeshSimplifier() = default;
+
+    std::vector<unsigned int> Cluster(const std::vector<unsigned int> &indices, float cellSize) const;
+    std::vector<unsigned int> Simplify(const std::vector<unsigned int> &indices, float ratio) const;
+};
+
+#endif /* MESH_SIMPLIFIER_HPP */
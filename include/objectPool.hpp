@@ -0,0 +1,159 @@
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// @brief Pool of short-lived objects (balls, particles, debris) referenced by generational handles.
+// @note Objects are stored densely, so that iterating them touches no holes. Despawning moves the last object
+// into the freed place, the slot table keeps handles stable across these moves. A slot's generation changes
+// whenever its object is despawned: handles to a despawned object are detected instead of reaching its successor.
+// @note Every array is allocated by the constructor or Reserve(): Spawn() and Despawn() are O(1) and never allocate.
+template<typename T>
+class ObjectPool
+{
+public:
+    struct Handle
+    {
+        static constexpr std::uint32_t NONE = ~0u;
+
+        std::uint32_t slot {NONE};
+        std::uint32_t generation {0};
+
+        bool operator==(const Handle &other) const
+        {
+            return slot == other.slot && generation == other.generation;
+        }
+        bool operator!=(const Handle &other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+private:
+    struct Slot
+    {
+        std::uint32_t dense;       // Index of the object while alive, next free slot otherwise
+        std::uint32_t generation;
+    };
+
+    std::vector<T> m_objects;
+    std::vector<std::uint32_t> m_denseToSlot;
+    std::vector<Slot> m_slots;
+    std::uint32_t m_freeSlot {Handle::NONE};
+
+public:
+    // @param capacity Maximum number of objects alive at once, until Reserve() raises it.
+    ObjectPool(size_t capacity = 0)
+    {
+        Reserve(capacity);
+    }
+    ~ObjectPool() = default;
+
+    // @brief Raises the capacity: the only call that allocates, the handles stay valid.
+    // @note Objects may be relocated, which invalidates the pointers returned by Get().
+    void Reserve(size_t capacity)
+    {
+        size_t first = m_slots.size();
+        if (capacity <= first)
+            return;
+        m_objects.reserve(capacity);
+        m_denseToSlot.reserve(capacity);
+        m_slots.resize(capacity);
+        // The new slots are chained in front of the free ones
+        for (size_t i = first; i < capacity; i++)
+        {
+            m_slots[i] = {i+1 < capacity ? static_cast<std::uint32_t>(i+1) : m_freeSlot, 0};
+        }
+        m_freeSlot = static_cast<std::uint32_t>(first);
+    }
+
+    // @brief Builds an object in the pool.
+    // @return Its handle, or a null handle (see IsAlive()) when the pool is full: see Reserve().
+    template<typename... Args>
+    Handle Spawn(Args &&...args)
+    {
+        if (m_freeSlot == Handle::NONE)
+            return Handle();
+
+        std::uint32_t slot = m_freeSlot;
+        m_freeSlot = m_slots[slot].dense;
+        m_slots[slot].dense = static_cast<std::uint32_t>(m_objects.size());
+        // Within the reserved capacity: never reallocates
+        m_objects.emplace_back(std::forward<Args>(args)...);
+        m_denseToSlot.push_back(slot);
+        return {slot, m_slots[slot].generation};
+    }
+
+    // @brief Destroys the object, the last one takes its place.
+    // @return false if the handle was null or its object already despawned.
+    bool Despawn(Handle handle)
+    {
+        if (!IsAlive(handle))
+            return false;
+
+        std::uint32_t dense = m_slots[handle.slot].dense;
+        std::uint32_t last = static_cast<std::uint32_t>(m_objects.size()-1);
+        if (dense != last)
+        {
+            m_objects[dense] = std::move(m_objects[last]);
+            m_denseToSlot[dense] = m_denseToSlot[last];
+            m_slots[m_denseToSlot[dense]].dense = dense;
+        }
+        m_objects.pop_back();
+        m_denseToSlot.pop_back();
+
+        m_slots[handle.slot].generation++;
+        m_slots[handle.slot].dense = m_freeSlot;
+        m_freeSlot = handle.slot;
+        return true;
+    }
+
+    bool IsAlive(Handle handle) const
+    {
+        return handle.slot < m_slots.size() && m_slots[handle.slot].generation == handle.generation
+            && m_slots[handle.slot].dense < m_objects.size() && m_denseToSlot[m_slots[handle.slot].dense] == handle.slot;
+    }
+
+    // @return nullptr if the object was despawned.
+    // @note The pointer is only valid until the next Despawn(), keep the handle instead.
+    T *Get(Handle handle)
+    {
+        return IsAlive(handle) ? &m_objects[m_slots[handle.slot].dense] : nullptr;
+    }
+    const T *Get(Handle handle) const
+    {
+        return IsAlive(handle) ? &m_objects[m_slots[handle.slot].dense] : nullptr;
+    }
+
+    // @brief Dense iteration over the objects alive, in no particular order.
+    typename std::vector<T>::iterator begin()
+    {
+        return m_objects.begin();
+    }
+    typename std::vector<T>::iterator end()
+    {
+        return m_objects.end();
+    }
+    typename std::vector<T>::const_iterator begin() const
+    {
+        return m_objects.begin();
+    }
+    typename std::vector<T>::const_iterator end() const
+    {
+        return m_objects.end();
+    }
+
+    size_t GetCount() const
+    {
+        return m_objects.size();
+    }
+    size_t GetCapacity() const
+    {
+        return m_slots.size();
+    }
+};
+
+#endif /* OBJECT_POOL_HPP */
@@ -4,37 +4,145 @@
 #include "entity.hpp"
 #include "camera.hpp"
 #include "shader.hpp"
+#include "textureArray.hpp"
+#include "table.hpp"
+#include "frameArena.hpp"
+#include "world.hpp"
+#include "components.hpp"
+#include "threadPool.hpp"
+#include "meshPool.hpp"
+#include "gpuCuller.hpp"
+#include "bounds.hpp"
+#include "softwareOcclusion.hpp"
+#include "hiZPyramid.hpp"
 
 // #include <vector>
 // #include <memory>
 
+// @brief Renderer and game systems over the entities of a World.
+// @note The World owns the entities, the Packet only runs the systems over them: rendering over
+// <Transform, Renderable>, the pose updates over <Transform>, physics over <Transform, RigidBody> and
+// contacts over <Transform, Collider>. Entities without a Renderable (debris, triggers...) are simulated, never drawn.
 class Packet
 {
+public:
+    // Below this many entities a system runs on the calling thread: waking the workers costs more than it saves
+    static constexpr size_t PARALLEL_THRESHOLD = 4096;
+    // A mesh switches level of detail once it is this ratio past the threshold, see ItemBuffer::SelectLod()
+    static constexpr float LOD_HYSTERESIS = 0.1f;
+
+    // How the meshes of the MeshPool are submitted, the others are always drawn one entity at a time
+    enum class DrawPath
+    {
+        Direct,     // One draw per entity, as if there was no pool
+        Instanced,  // One instanced draw per mesh
+        Indirect    // One glMultiDrawElementsIndirect() per vertex layout of the pool
+    };
+
+private:
     glm::vec3 x = glm::vec3(1.0, 0.0, 0.0);
     glm::vec3 y = glm::vec3(0.0, 1.0, 0.0);
     glm::vec3 z = glm::vec3(0.0, 0.0, 1.0);
 
+    // One draw recorded for the GL thread, replayed in (mesh, material) order
+    struct DrawCommand
+    {
+        ItemBuffer *mesh;
+        int material;
+        int lod;
+        const glm::mat4 *model;
+        bool occluder;
+    };
+
 private:
-    std::vector<Entity> m_entities;
+    World *m_world;
+    std::vector<EntityId> m_tableEntities; // For the index of MoveEntity() and UpdateEntity()
     Camera *m_camera;
     Shader *m_shader;
+    TextureArray *m_textures {nullptr};
+    FrameArena *m_arena {nullptr};
+    ThreadPool *m_pool {nullptr};
+    MeshPool *m_meshPool {nullptr};
+    GpuCuller *m_culler {nullptr};
+    SoftwareOcclusion *m_softwareOcclusion {nullptr};
+    HiZPyramid *m_hiZ {nullptr};
+    float m_minOccluderRadius {0.0f};
+    bool m_cullingStats {false};
+    bool m_lodSelection {false};
+    int m_instancedVariant;                 // Of the shader, for the meshes drawn from the pool
+    std::uint64_t m_cameraVersions[2] {~std::uint64_t(0), ~std::uint64_t(0)}; // Last sent to each variant
+    std::uint64_t m_shaderVersion {0};      // Of the programs the camera was sent to, see Shader::SwapReloaded()
+    DrawPath m_drawPath {DrawPath::Direct};
+    unsigned int m_drawCalls {0};
+    size_t m_testedCount {0};
+    size_t m_culledCount {0};
+    size_t m_gpuTestedCount {0};            // Last read back from the GpuCuller, kept until the next one
+    size_t m_gpuCulledCount {0};
+
+    DrawCommand *__RecordCommands(size_t &count);
+    DrawCommand *__SortCommands(DrawCommand *commands, size_t count);
+    Transform *__GetTableTransform(int index);
+    bool __IsOccluder(const DrawCommand &command) const;
+    size_t __CullSoftware(DrawCommand *commands, size_t count);
+    void __BuildHiZ(const DrawCommand *commands, size_t count);
+    void __DrawPooled(const DrawCommand *commands, size_t count);
+    void __UseVariant(bool instanced);
     
 public:
-    Packet(Camera *cam, Shader *shader);
+    Packet(Camera *cam, Shader *shader, World *world);
     ~Packet();
 
-    void AddEntity(Entity &entity);
+    EntityId AddEntity(Entity &entity);
+    void AddEntities(const Table &table, const std::vector<ItemBuffer *> &meshes, const std::vector<int> &materials);
+
+    EntityId SpawnEntity(ItemBuffer *mesh, const glm::vec3 &position, const glm::vec3 &rotationAxis, float rotationAngle,
+                         const glm::vec3 &scale, const glm::vec3 &velocity = glm::vec3(0.0f));
+    bool DespawnEntity(EntityId id);
+    void SetTextureArray(TextureArray *textures);
+    void SetFrameArena(FrameArena *arena);
+    void SetThreadPool(ThreadPool *pool);
+    void SetMeshPool(MeshPool *meshes, DrawPath path = DrawPath::Indirect);
+    void SetGpuCuller(GpuCuller *culler);
+    void SetSoftwareOcclusion(SoftwareOcclusion *occlusion, float minOccluderRadius);
+    void SetHiZOcclusion(HiZPyramid *pyramid, float minOccluderRadius);
+    void SetCullingStats(bool enabled);
+    void SetLodSelection(bool enabled);
 
     void MoveEntity(glm::mat4 &model, int index = 0);
-    void UpdateEntity(glm::vec3 &translationAxis = glm::vec3(0.0f),
-                    glm::vec3 &rotationAxis = glm::vec3(0.0f),
+    void UpdateEntity(const glm::vec3 &translationAxis = glm::vec3(0.0f),
+                    const glm::vec3 &rotationAxis = glm::vec3(0.0f),
                     float rotationAngle = 0.0f,
-                    glm::vec3 &scaleFactor = glm::vec3(1.0f),
+                    const glm::vec3 &scaleFactor = glm::vec3(1.0f),
                     int index = 0);
+    void Simulate(float timeFrame);
 
     void CheckContact(float timeFrame, double x_mouse, double y_mouse);
     void Render(float timeFrame);
+
+    World *GetWorld() const
+    {
+        return m_world;
+    }
+    DrawPath GetDrawPath() const
+    {
+        return m_drawPath;
+    }
+    // @brief Draw calls of the last Render().
+    unsigned int GetDrawCallCount() const
+    {
+        return m_drawCalls;
+    }
+    // @brief Share of the entities tested by the last Render() that were culled, frustum and occlusion alike.
+    // @note With GPU culling, by the last Render() the GPU is done with, a few frames back.
+    float GetCulledFraction() const
+    {
+        return m_testedCount ? static_cast<float>(m_culledCount) / m_testedCount : 0.0f;
+    }
+    size_t GetEntityCount() const
+    {
+        return m_world->GetCount();
+    }
 };
 
 
-#endif /* ENVIRONMENT_HPP */
\ No newline at end of file
+#endif /* ENVIRONMENT_HPP */
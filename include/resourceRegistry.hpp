@@ -0,0 +1,51 @@
+#ifndef RESOURCE_REGISTRY_HPP
+#define RESOURCE_REGISTRY_HPP
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// @brief Owns the GPU resources shared by many objects (meshes, textures...), looked up by name.
+// @note Resources are built in place and never move: the pointers handed out stay valid as long as the
+// registry lives. Objects sharing a resource only keep such a pointer, so copying or relocating them
+// never touches the driver.
+template<typename T>
+class ResourceRegistry
+{
+private:
+    std::deque<T> m_resources;
+    std::unordered_map<std::string, T *> m_names;
+
+public:
+    ResourceRegistry() {}
+    ~ResourceRegistry() = default;
+    ResourceRegistry(const ResourceRegistry &) = delete;
+    ResourceRegistry &operator=(const ResourceRegistry &) = delete;
+
+    // @brief Builds the resource from the given arguments, unless one already has this name.
+    // @return The resource registered under that name.
+    template<typename... Args>
+    T *Add(const std::string &name, Args &&...args)
+    {
+        if (T *existing = Find(name))
+            return existing;
+        T *resource = &m_resources.emplace_back(std::forward<Args>(args)...);
+        m_names.emplace(name, resource);
+        return resource;
+    }
+
+    // @return nullptr if nothing was registered under that name.
+    T *Find(const std::string &name) const
+    {
+        auto it = m_names.find(name);
+        return it != m_names.end() ? it->second : nullptr;
+    }
+
+    size_t GetCount() const
+    {
+        return m_resources.size();
+    }
+};
+
+#endif /* RESOURCE_REGISTRY_HPP */
@@ -1,6 +1,7 @@
 #ifndef SHADER_HPP
 #define SHADER_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -21,15 +22,39 @@ private:
     #if WINDOWS_MSVC
     std::string m_filePath = "C:\\Users\\Elouan THEOT\\Documents\\Programming\\c++\\Flipper_Project_Cpp\\shaders\\";
     #else
-    std::string m_filePath = "/home/...";
+    std::string m_filePath = "shaders/"; // Relative to the source folder, where the pgo target runs flipper
     #endif
-    std::string m_sourceCode;
     // std::string m_vertexShader;
     // std::string m_geometryShader;
     std::string m_fragmentShader;
     unsigned int m_program;
 
+    // One program per set of #define lines, compiled the first time it's used
+    struct Variant
+    {
+        std::string defines;
+        unsigned int program;       // In use, 0 until it's first built
+        // While the driver compiles it: the program being built, its stages and the hash of its sources
+        unsigned int building;
+        std::vector<unsigned int> shaders;
+        std::uint64_t hash;
+        std::uint64_t key;          // Its entry in the shader cache: files and defines, whatever their content
+    };
+    std::string m_fileNames[2];
+    GLenum m_shaderTypes[2];
+    int m_stageCount {0};
+    std::string m_defines;                  // Shared by every variant
+    std::vector<Variant> m_variants {{"", 0, 0, {}, 0, 0}}; // The first one has no defines of its own
+    int m_variant {0};
+    bool m_reloading {false};
+    std::uint64_t m_version {0};
+
     std::string Parse(const std::string &fileName);
+    void __StartVariant(int variant);
+    bool __FinishVariant(int variant);
+    void __DiscardBuild(Variant &variant);
+    unsigned int __CompileSource(const std::string &source, GLenum shaderType);
+    bool __CheckShader(unsigned int shader) const;
 
 public:
     Shader() {}
@@ -37,15 +62,50 @@ public:
 
     // TODO: Error handling
     unsigned int CreateShaderProgram(const std::string &vertexShaderFileName, const std::string &fragmentShaderFileName);
+    unsigned int CreateComputeProgram(const std::string &computeShaderFileName);
+    void StartShaderProgram(const std::string &vertexShaderFileName, const std::string &fragmentShaderFileName);
     unsigned int Compile(const std::string &fileName, GLenum shaderType);
+    void SetDefines(const std::string &defines);
+    int AddVariant(const std::string &defines);
+    void StartVariant(int variant);
+    bool IsVariantReady(int variant);
+    void UseVariant(int variant);
+    bool Uses(const std::string &fileName) const;
+    void StartReload();
+    bool SwapReloaded();
+    static std::string Define(const std::string &name, int value = 1);
     void UseProgram();
     void DeleteProgram();
     void SetBool(const std::string &name, bool value, int size = 1) const;
     void SetInt(const std::string &name, int value, int size = 1) const;
     void SetFloat(const std::string &name, float *values, int size = 1) const;
     void SetMatrix4fv(const std::string &name, const float *mat4) const;
+    // Same setters for a location looked up once, e.g. before a loop over many draws
+    int GetUniformLocation(const std::string &name) const;
+    void SetInt(int location, int value) const;
+    void SetMatrix4fv(int location, const float *mat4) const;
     
     unsigned int GetShaderProgram() const;
+    // @brief Between StartReload() and the SwapReloaded() that ends it.
+    bool IsReloading() const
+    {
+        return m_reloading;
+    }
+    // @brief Incremented by every SwapReloaded() that replaced a program: the uniforms set so far are lost.
+    std::uint64_t GetVersion() const
+    {
+        return m_version;
+    }
+    // @brief Index of the variant UseVariant() last made current, 0 for the program without defines.
+    int GetVariant() const
+    {
+        return m_variant;
+    }
+    // @brief Folder the shader files are read from.
+    const std::string &GetFilePath() const
+    {
+        return m_filePath;
+    }
 };
 
 
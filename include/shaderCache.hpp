@@ -0,0 +1,67 @@
+#ifndef SHADER_CACHE_HPP
+#define SHADER_CACHE_HPP
+
+#if WINDOWS_MSVC
+#include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
+
+#include <cstdint>
+#include <string>
+
+// @brief On-disk cache of linked programs, in the driver's own binary format (glGetProgramBinary()).
+// @note One file per program, named after its key (its files and defines): Header, then the binary. The header
+// keeps the hash of the sources the binary was built from, a newer build of the program replaces it.
+// It also keeps a hash of the driver (vendor, renderer, version), a binary from another driver is never even
+// tried and Enable() deletes it. A binary the driver rejects anyway (updated driver, other GPU) is recompiled and replaced.
+class ShaderCache
+{
+public:
+    static constexpr std::uint32_t MAGIC = 0x47525046; // "FPRG"
+    static constexpr std::uint32_t VERSION = 2;
+
+    struct Header
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t programKey;
+        std::uint64_t sourceHash;
+        std::uint64_t driverHash;
+        std::uint32_t binaryFormat;
+        std::uint32_t binarySize;
+    };
+
+    // @brief Where the programs of this run came from, for the startup report.
+    struct Stats
+    {
+        unsigned int loaded;
+        unsigned int compiled;
+        double seconds;           // The caller waited on, creating programs: cache hits and misses alike
+    };
+
+private:
+    static inline bool s_enabled {false};
+    static inline std::string s_directory;
+    static inline std::uint64_t s_driverHash {0};
+    static inline Stats s_stats {0, 0, 0.0};
+
+    static std::string __GetPath(std::uint64_t programKey);
+    static void __Prune();
+
+public:
+    static void Enable(const std::string &directory);
+    static bool Load(GLuint program, std::uint64_t programKey, std::uint64_t sourceHash);
+    static void Store(GLuint program, std::uint64_t programKey, std::uint64_t sourceHash);
+
+    static bool IsEnabled()
+    {
+        return s_enabled;
+    }
+    static Stats &GetStats()
+    {
+        return s_stats;
+    }
+};
+
+#endif /* SHADER_CACHE_HPP */
@@ -0,0 +1,40 @@
+#ifndef SOFTWARE_OCCLUSION_HPP
+#define SOFTWARE_OCCLUSION_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+
+// @brief Occlusion culling on the CPU: the large occluders are rasterized into a small depth buffer, whose
+// max-depth mip pyramid then rejects the entities hidden behind them.
+// @note Occluders are rasterized as their bounding box: only meshes that fill their box (walls, backboxes,
+// blocks) should be occluders, or entities seen through them would be culled. Tables flag them (see Table::Mesh).
+// @note Conservative: a pixel is written only once its whole square is covered, with the farthest depth the
+// occluder has over it, so the buffer never claims more than the occluders hide.
+class SoftwareOcclusion
+{
+private:
+    int m_width;
+    int m_height;
+    std::vector<float> m_depth;          // Every level of the pyramid, level 0 first
+    std::vector<size_t> m_levelOffsets;
+    std::vector<glm::ivec2> m_levelSizes;
+    std::vector<float> m_coverage;       // Nearest depth of the occluder being added at each pixel center
+    glm::mat4 m_viewProjection;
+
+    void __RasterizeTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c);
+
+public:
+    SoftwareOcclusion(int width = 256, int height = 160);
+    ~SoftwareOcclusion() = default;
+
+    void Begin(const glm::mat4 &viewProjection);
+    void AddOccluder(const glm::mat4 &model, const BoundingBox &box);
+    void Finish();
+    bool IsOccluded(const glm::vec3 &center, float radius) const;
+};
+
+#endif /* SOFTWARE_OCCLUSION_HPP */
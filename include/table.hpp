@@ -0,0 +1,87 @@
+#ifndef TABLE_HPP
+#define TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// @brief Data-driven description of a flipper table: the meshes, the materials and every entity of the board.
+// @note Text format, one declaration per line, '#' starts a comment:
+//   entities <count>                  Optional, lets the parser reserve everything up front (at most MAX_ENTITIES)
+//   mesh <name> <source> [occluder]   "cube" for the built-in cube, or a .fmesh file next to the table (see MeshFile).
+//                                     occluder: the mesh is closed and fills its bounding box (walls, blocks), large
+//                                     entities of it hide the others. Never for ramps or other open geometry.
+//   material <name> <image>           A layer of the board texture array
+//   entity <mesh> <material> <px py pz> <rx ry rz angle> <sx sy sz> <mass restitution friction>
+// Meshes and materials are declared before the entities using them. Angles are in degrees.
+// @note The file is mapped and parsed in a single pass: entities are stored by value, with the index of their
+// mesh and material, so loading costs a handful of allocations whatever the number of entities.
+class Table
+{
+public:
+    // Largest count an "entities" declaration may reserve
+    static constexpr size_t MAX_ENTITIES = 1 << 20;
+
+    struct Mesh
+    {
+        std::string name;
+        std::string source;
+        bool occluder;
+    };
+
+    struct Material
+    {
+        std::string name;
+        std::string image;
+    };
+
+    struct Placement
+    {
+        std::uint32_t mesh;
+        std::uint32_t material;
+        float position[3];
+        float rotationAxis[3];
+        float rotationAngle;
+        float scale[3];
+        float mass;
+        float restitution;
+        float friction;
+    };
+
+private:
+    std::string m_folder;
+    std::vector<Mesh> m_meshes;
+    std::vector<Material> m_materials;
+    std::vector<Placement> m_placements;
+
+    bool __ParseLine(std::string_view keyword, const char *&cursor, const char *end);
+
+public:
+    Table() {}
+    ~Table() = default;
+
+    bool Load(const std::string &path);
+    bool Parse(const char *data, size_t size);
+
+    // @brief Where the table file is, mesh sources are relative to it.
+    const std::string &GetFolder() const
+    {
+        return m_folder;
+    }
+    const std::vector<Mesh> &GetMeshes() const
+    {
+        return m_meshes;
+    }
+    const std::vector<Material> &GetMaterials() const
+    {
+        return m_materials;
+    }
+    const std::vector<Placement> &GetPlacements() const
+    {
+        return m_placements;
+    }
+};
+
+#endif /* TABLE_HPP */
@@ -0,0 +1,72 @@
+#ifndef TEXTURE_ARRAY_HPP
+#define TEXTURE_ARRAY_HPP
+
+#if WINDOWS_MSVC
+#include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include "textureLoader.hpp"
+#include "gpuHandle.hpp"
+
+// @brief Packs the board's images in the layers of one GL_TEXTURE_2D_ARRAY.
+// @note Each vertex picks its image with a layer index (see AppendLayer()), so every board element
+// shares the same texture bind and can be drawn in the same batch. Unlike an atlas, layers keep
+// GL_REPEAT wrapping and mipmaps don't bleed between images.
+// @note Layers go through the TextureLoader: decoded and resized to the layer size by the thread pool, or mapped
+// from the texture cache with their mip chain, then uploaded by the loader's Update() within its time budget.
+// Until then the layers show a placeholder color.
+class TextureArray
+{
+    static constexpr unsigned char PLACEHOLDER[4] = {255, 0, 255, 255};
+
+    struct Layer
+    {
+        std::string img;
+        std::shared_future<bool> uploaded;
+    };
+
+private:
+    Texture m_texture;
+    int m_width;
+    int m_height;
+    int m_wrappingParam;
+    TextureLoader *m_loader;
+    std::vector<Layer> m_layers;
+    unsigned int m_allocatedLayers {0};
+
+public:
+    // @param width, height Size of every layer, images are resized to it.
+    TextureArray(TextureLoader *loader, int width = 512, int height = 512, int wrappingParam = GL_REPEAT);
+    ~TextureArray() = default;
+    TextureArray(const TextureArray &) = delete;
+    TextureArray &operator=(const TextureArray &) = delete;
+
+    int AddLayer(const std::string &img);
+    bool ReloadLayer(const std::string &img);
+    void Allocate();
+    void Bind(unsigned int unit = 0);
+    bool IsComplete() const;
+
+    static std::vector<float> AppendLayer(const float *vertices, size_t vertexCount, unsigned int stride, float layer);
+
+    unsigned int GetTexture() const
+    {
+        return m_texture.Get();
+    }
+    const std::string &GetImagePath() const
+    {
+        return m_loader->GetImagePath();
+    }
+    int GetLayerCount() const
+    {
+        return static_cast<int>(m_layers.size());
+    }
+};
+
+#endif /* TEXTURE_ARRAY_HPP */
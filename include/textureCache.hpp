@@ -0,0 +1,79 @@
+#ifndef TEXTURE_CACHE_HPP
+#define TEXTURE_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mappedFile.hpp"
+
+// @brief GPU-ready texture file: a pre-built mip chain, raw RGBA8 or BC1 compressed.
+// @note Layout: TextureCacheHeader, then header.levels TextureCacheLevel, then the pixels of every level.
+// The file remembers the hash of the image it was built from and is discarded when that image changes.
+class TextureCache
+{
+public:
+    static constexpr std::uint32_t MAGIC = 0x43585446; // "FTXC"
+    static constexpr std::uint32_t VERSION = 1;
+    // Same values as the GL enums, the file doesn't depend on the GL headers
+    static constexpr std::uint32_t FORMAT_RGBA8 = 0x8058; // GL_RGBA8
+    static constexpr std::uint32_t FORMAT_BC1 = 0x83F1; // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+
+    struct Header
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t sourceHash;
+        std::uint32_t format;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t levels;
+    };
+
+    struct Level
+    {
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint64_t offset; // From the beginning of the file
+        std::uint64_t size;
+    };
+
+private:
+    MappedFile m_file;
+    const Header *m_header {nullptr};
+    const Level *m_levels {nullptr};
+
+public:
+    TextureCache() {}
+    ~TextureCache() = default;
+
+    static bool HashSource(const std::string &sourcePath, std::uint64_t &hash);
+    static void BuildLevels(const unsigned char *pixels, int width, int height, int channels, std::uint32_t format,
+                            std::vector<Level> &levels, std::vector<std::vector<unsigned char>> &levelData);
+    static bool Write(const std::string &cachePath, std::uint64_t sourceHash, const unsigned char *pixels,
+                      int width, int height, int channels, std::uint32_t format = FORMAT_RGBA8);
+    static bool WriteLevels(const std::string &cachePath, std::uint64_t sourceHash, std::uint32_t format,
+                            std::vector<Level> levels, const std::vector<std::vector<unsigned char>> &levelData);
+    static bool Build(const std::string &sourcePath, const std::string &cachePath, std::uint32_t format = FORMAT_RGBA8);
+
+    bool Open(const std::string &cachePath, std::uint64_t sourceHash);
+
+    bool IsCompressed() const
+    {
+        return m_header->format != FORMAT_RGBA8;
+    }
+    const Header &GetHeader() const
+    {
+        return *m_header;
+    }
+    const Level &GetLevel(unsigned int level) const
+    {
+        return m_levels[level];
+    }
+    const unsigned char *GetLevelData(unsigned int level) const
+    {
+        return m_file.GetData() + m_levels[level].offset;
+    }
+};
+
+#endif /* TEXTURE_CACHE_HPP */
@@ -0,0 +1,86 @@
+#ifndef TEXTURE_LOADER_HPP
+#define TEXTURE_LOADER_HPP
+
+#if WINDOWS_MSVC
+#include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
+
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "threadPool.hpp"
+#include "textureCache.hpp"
+
+// @brief Loads 2D textures without stalling the GL thread.
+// @note Images are decoded by the thread pool, then uploaded by Update() through a pixel buffer
+// object within a per-frame time budget. Until then the texture holds a 1x1 placeholder,
+// so its name can be bound right away.
+// @note Decoded images are saved in the cache folder with their mip chain (see TextureCache):
+// the next launches map the cache file and upload its levels as is, without decoding.
+// @note LoadLayer() fills a layer of a texture array the same way (see TextureArray), resized to the layer size
+// and always with its whole mip chain, from the cache or built by the worker: the GL thread never generates mipmaps.
+class TextureLoader
+{
+    // RGBA of the placeholder texel
+    static constexpr unsigned char PLACEHOLDER[4] = {255, 0, 255, 255};
+
+    struct DecodedImage
+    {
+        unsigned int texture;
+        int layer; // Of a GL_TEXTURE_2D_ARRAY, -1 for a GL_TEXTURE_2D
+        unsigned char *data;
+        int width;
+        int height;
+        int channels;
+        std::shared_ptr<std::promise<bool>> ready;
+        std::shared_ptr<TextureCache> cache; // Set when the mip chain comes from the cache
+        // Mip chain of a layer, when it is not in the cache
+        std::vector<TextureCache::Level> levels;
+        std::vector<std::vector<unsigned char>> levelData;
+    };
+
+private:
+    ThreadPool *m_pool;
+    double m_uploadBudget;
+    unsigned int m_PBO {0};
+    #if WINDOWS_MSVC
+    std::string m_imgPath = "C:\\Users\\Elouan THEOT\\Documents\\Programming\\c++\\Flipper_Project_Cpp\\img\\";
+    #else
+    std::string m_imgPath = "img/"; // Relative to the source folder, like the shaders
+    #endif
+    std::string m_cachePath;
+    std::mutex m_mutex;
+    std::deque<DecodedImage> m_decoded;
+    std::vector<std::future<void>> m_pending;
+
+    std::shared_future<bool> __Queue(DecodedImage image, const std::string &img);
+    void __Decode(DecodedImage &image, const std::string &img);
+    void __DecodeLayer(DecodedImage &image, const std::string &img);
+    void __Upload(DecodedImage &image);
+    void __UploadCache(DecodedImage &image);
+    void __UploadLayer(DecodedImage &image);
+
+public:
+    // @param uploadBudget In milliseconds, the time Update() may spend uploading each frame.
+    TextureLoader(ThreadPool *pool, double uploadBudget = 2.0);
+    ~TextureLoader();
+    TextureLoader(const TextureLoader &) = delete;
+    TextureLoader &operator=(const TextureLoader &) = delete;
+
+    std::shared_future<bool> Load(unsigned int texture, const std::string &img);
+    std::shared_future<bool> LoadLayer(unsigned int texture, int layer, int width, int height, const std::string &img);
+    unsigned int Update();
+    bool IsIdle();
+
+    const std::string &GetImagePath() const
+    {
+        return m_imgPath;
+    }
+};
+
+#endif /* TEXTURE_LOADER_HPP */
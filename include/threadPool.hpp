@@ -0,0 +1,89 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// @brief Fixed set of worker threads running the tasks submitted to it in FIFO order.
+// @note Tasks must not touch OpenGL: the context is only current on the main thread.
+// @note ParallelFor() splits a loop over the workers and the calling thread without allocating.
+class ThreadPool
+{
+private:
+    // The loop ParallelFor() is running, owned by the pool so that late helpers never outlive it
+    struct ParallelJob
+    {
+        void (*run)(void *context, size_t begin, size_t end) {nullptr};
+        void *context {nullptr};
+        size_t count {0};
+        size_t batchSize {1};
+        size_t batchCount {0};
+        std::atomic<size_t> nextBatch {0};
+        std::atomic<size_t> doneBatches {0};
+        std::atomic<unsigned int> activeHelpers {0};
+        std::atomic<bool> open {false};
+    };
+
+    std::vector<std::thread> m_workers;
+    // Ring buffer of tasks: reused storage, unlike a std::queue
+    std::vector<std::function<void()>> m_tasks;
+    size_t m_taskHead {0};
+    size_t m_taskCount {0};
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop {false};
+    ParallelJob m_job;
+
+    void __Work();
+    void __Push(std::function<void()> &&task);
+    void __RunBatches();
+    void __ParallelFor(size_t count, size_t batchSize, void (*run)(void *, size_t, size_t), void *context);
+
+public:
+    // @param threadCount 0 picks one thread per core, minus the main thread.
+    ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // @brief Queues a task and returns the future of its result.
+    template<typename F>
+    std::future<std::invoke_result_t<F>> Submit(F &&task)
+    {
+        using R = std::invoke_result_t<F>;
+        // std::function needs a copyable callable, std::packaged_task is move-only
+        auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+        std::future<R> result = packaged->get_future();
+        __Push([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    // @brief Runs body(begin, end) over batches of [0, count), on the workers and the calling thread.
+    // @param batchSize Number of iterations a thread claims at once.
+    // @note Blocks until the whole range ran. Only one thread may run a ParallelFor() at a time (the main one).
+    template<typename F>
+    void ParallelFor(size_t count, size_t batchSize, F &&body)
+    {
+        using Body = std::remove_reference_t<F>;
+        auto run = [](void *context, size_t begin, size_t end)
+        {
+            (*static_cast<Body *>(context))(begin, end);
+        };
+        __ParallelFor(count, batchSize, run, const_cast<void *>(static_cast<const void *>(&body)));
+    }
+
+    unsigned int GetThreadCount() const
+    {
+        return static_cast<unsigned int>(m_workers.size());
+    }
+};
+
+#endif /* THREAD_POOL_HPP */
@@ -0,0 +1,76 @@
+#ifndef VERTEX_LAYOUT_HPP
+#define VERTEX_LAYOUT_HPP
+
+#if WINDOWS_MSVC
+#include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
+
+#include <cstddef>
+#include <vector>
+
+// @brief Describes how vertex attributes are stored on the GPU, possibly in a more compact type than float.
+// @note Supported types: GL_FLOAT, GL_HALF_FLOAT, GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_SHORT
+// (normalized or not) and GL_INT_2_10_10_10_REV (normalized, for normals and tangents).
+// Attributes are grouped in streams: one buffer per stream, interleaved inside a stream.
+// Convert() builds the streams from the float arrays the geometry is written with.
+// @note Only relies on the GL enums: offline tools use it without an OpenGL context.
+class VertexLayout
+{
+public:
+    struct Attribute
+    {
+        unsigned int index;        // Shader location
+        unsigned int components;
+        GLenum type;
+        bool normalized;
+        unsigned int sourceOffset; // In floats, position of the attribute in the source vertex
+        unsigned int stream;
+        unsigned int offset;       // In bytes, position of the attribute in its stream's vertex
+    };
+
+private:
+    std::vector<Attribute> m_attributes;
+    std::vector<unsigned int> m_strides;
+
+public:
+    VertexLayout() {}
+    ~VertexLayout() = default;
+
+    VertexLayout &Add(unsigned int index, unsigned int components, GLenum type, bool normalized,
+                      unsigned int sourceOffset, unsigned int stream = 0);
+
+    std::vector<std::vector<unsigned char>> Convert(const float *vertices, size_t vertexCount, unsigned int sourceStride) const;
+
+    bool IsCompatible(const VertexLayout &other) const;
+    bool IsValid() const;
+
+    static unsigned short ToHalf(float value);
+    static unsigned int AttributeSize(unsigned int components, GLenum type);
+
+    const std::vector<Attribute> &GetAttributes() const
+    {
+        return m_attributes;
+    }
+    unsigned int GetStreamCount() const
+    {
+        return static_cast<unsigned int>(m_strides.size());
+    }
+    // @brief In bytes, the size of one vertex in the given stream.
+    unsigned int GetStride(unsigned int stream = 0) const
+    {
+        return m_strides[stream];
+    }
+    unsigned int GetVertexSize() const
+    {
+        unsigned int size = 0;
+        for (unsigned int stride: m_strides)
+        {
+            size += stride;
+        }
+        return size;
+    }
+};
+
+#endif /* VERTEX_LAYOUT_HPP */
@@ -0,0 +1,297 @@
+#ifndef WORLD_HPP
+#define WORLD_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "threadPool.hpp"
+#include "objectPool.hpp"
+
+// @brief Handle of an entity of the World: stable while the entity lives, detected as stale once it's destroyed.
+struct EntityId
+{
+    static constexpr std::uint32_t NONE = ~0u;
+
+    std::uint32_t index {NONE};
+    std::uint32_t generation {0};
+
+    bool operator==(const EntityId &other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const EntityId &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// @brief Archetype-based entity-component-system: entities are ids, their data are components (see components.hpp).
+// @note Entities with the same set of components share an archetype, which stores them in 16 KB chunks with
+// one array per component (SoA), each array starting on a cache line. A query streams through the arrays
+// it asks for and never loads the components it doesn't use.
+// @note Components are plain data: entities are relocated with memcpy, by the swap-remove of Destroy() or when
+// a component is added or removed. Chunks are kept once allocated and the ids come from an ObjectPool of records,
+// so a world that reached its peak size creates and destroys entities without allocating.
+class World
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 16*1024;
+    static constexpr size_t CACHE_LINE = 64;
+    static constexpr unsigned int MAX_COMPONENTS = 32;
+    using Mask = std::uint32_t;
+
+private:
+    struct Archetype
+    {
+        Mask mask;
+        size_t capacity;                                   // Entities per chunk
+        std::array<size_t, MAX_COMPONENTS> offsets;        // Of each component array in a chunk
+        size_t idOffset;                                   // Of the EntityId array in a chunk
+        std::vector<unsigned char *> chunks;               // All full but the last used one, the rest are spare
+        size_t count {0};
+    };
+
+    // Where an entity is, its id is the handle of its record
+    struct Record
+    {
+        Archetype *archetype;
+        size_t row;                // In the archetype
+    };
+    using RecordPool = ObjectPool<Record>;
+
+    static inline std::array<size_t, MAX_COMPONENTS> s_componentSizes {};
+    static inline std::uint32_t s_componentCount {0};
+
+    std::vector<std::unique_ptr<Archetype>> m_archetypes;
+    RecordPool m_records;
+    struct ParallelChunk
+    {
+        Archetype *archetype;
+        size_t chunk;
+        size_t first;     // Rank of the chunk's first entity in the query
+    };
+    std::vector<ParallelChunk> m_parallelChunks; // Scratch of ParallelEachChunk()
+
+    static std::uint32_t __RegisterComponent(size_t size, size_t alignment);
+    Archetype *__GetArchetype(Mask mask);
+    void __Reserve(Archetype *archetype, size_t count);
+    EntityId __NewId();
+    size_t __AllocateRow(Archetype *archetype, EntityId id);
+    void __RemoveRow(Archetype *archetype, size_t row);
+    void __MoveEntity(EntityId id, Mask mask);
+
+    static RecordPool::Handle __Handle(EntityId id)
+    {
+        return {id.index, id.generation};
+    }
+    Record &__Record(EntityId id)
+    {
+        return *m_records.Get(__Handle(id));
+    }
+
+    void *__Component(const Archetype *archetype, size_t row, std::uint32_t component) const
+    {
+        return archetype->chunks[row / archetype->capacity] + archetype->offsets[component]
+             + (row % archetype->capacity)*s_componentSizes[component];
+    }
+
+    // @brief Calls f(count, arrays...) for every chunk of this archetype.
+    template<typename... Cs, typename F>
+    static void __EachChunk(const Archetype &archetype, size_t chunk, F &f)
+    {
+        size_t first = chunk*archetype.capacity;
+        size_t count = archetype.count - first < archetype.capacity ? archetype.count - first : archetype.capacity;
+        unsigned char *data = archetype.chunks[chunk];
+        f(count, reinterpret_cast<Cs *>(data + archetype.offsets[ComponentIndex<Cs>()])...);
+    }
+
+public:
+    World() {}
+    ~World();
+    World(const World &) = delete;
+    World &operator=(const World &) = delete;
+
+    // @brief The index of a component type, registered on first use.
+    template<typename T>
+    static std::uint32_t ComponentIndex()
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Components are relocated with memcpy");
+        static const std::uint32_t index = __RegisterComponent(sizeof(T), alignof(T));
+        return index;
+    }
+    template<typename... Cs>
+    static Mask MaskOf()
+    {
+        return (Mask(0) | ... | (Mask(1) << ComponentIndex<Cs>()));
+    }
+
+    // @brief Makes room for count more entities with these components: no allocation until then.
+    template<typename... Cs>
+    void Reserve(size_t count)
+    {
+        __Reserve(__GetArchetype(MaskOf<Cs...>()), count);
+    }
+
+    template<typename... Cs>
+    EntityId Create(const Cs &...components)
+    {
+        Archetype *archetype = __GetArchetype(MaskOf<Cs...>());
+        EntityId id = __NewId();
+        size_t row = __AllocateRow(archetype, id);
+        (std::memcpy(__Component(archetype, row, ComponentIndex<Cs>()), &components, sizeof(Cs)), ...);
+        return id;
+    }
+    bool Destroy(EntityId id);
+
+    bool IsAlive(EntityId id) const
+    {
+        return m_records.IsAlive(__Handle(id));
+    }
+
+    // @return nullptr if the entity is dead or doesn't have this component.
+    // @note The pointer is only valid until entities are destroyed or change components, keep the id instead.
+    template<typename T>
+    T *Get(EntityId id)
+    {
+        const Record *record = m_records.Get(__Handle(id));
+        if (!record)
+            return nullptr;
+        std::uint32_t component = ComponentIndex<T>();
+        if (!(record->archetype->mask & (Mask(1) << component)))
+            return nullptr;
+        return static_cast<T *>(__Component(record->archetype, record->row, component));
+    }
+
+    // @brief Adds or overwrites a component, moving the entity to its new archetype.
+    template<typename T>
+    void Add(EntityId id, const T &component)
+    {
+        if (!IsAlive(id))
+            return;
+        Mask mask = __Record(id).archetype->mask | MaskOf<T>();
+        if (mask != __Record(id).archetype->mask)
+            __MoveEntity(id, mask);
+        std::memcpy(Get<T>(id), &component, sizeof(T));
+    }
+    template<typename T>
+    void Remove(EntityId id)
+    {
+        if (IsAlive(id) && (__Record(id).archetype->mask & MaskOf<T>()))
+            __MoveEntity(id, __Record(id).archetype->mask & ~MaskOf<T>());
+    }
+
+    // @brief Calls f(count, Cs *arrays...) for every chunk holding these components (and maybe others).
+    template<typename... Cs, typename F>
+    void EachChunk(F &&f)
+    {
+        Mask mask = MaskOf<Cs...>();
+        for (auto &archetype: m_archetypes)
+        {
+            if ((archetype->mask & mask) != mask)
+                continue;
+            for (size_t chunk = 0; chunk*archetype->capacity < archetype->count; chunk++)
+            {
+                __EachChunk<Cs...>(*archetype, chunk, f);
+            }
+        }
+    }
+
+    // @brief Calls f(Cs &components...) for every entity having these components.
+    template<typename... Cs, typename F>
+    void Each(F &&f)
+    {
+        EachChunk<Cs...>([&f](size_t count, Cs *...arrays)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                f(arrays[i]...);
+            }
+        });
+    }
+
+    // @brief Calls f(first, count, Cs *arrays...) for every chunk holding these components, the chunks are shared
+    // between the threads of the pool. first is the rank of the chunk's first entity in the query, so each chunk
+    // can write its results at its own place in a shared output.
+    // @param chunksPerBatch Chunks a thread claims at once, 0 gives each thread about 8 batches to balance the load.
+    // @note Chunks start on a cache line and hold whole arrays: no two threads ever write the same line.
+    // @note f runs concurrently: it may only write the components it is given.
+    template<typename... Cs, typename F>
+    void ParallelEachChunk(ThreadPool &pool, F &&f, size_t chunksPerBatch = 0)
+    {
+        Mask mask = MaskOf<Cs...>();
+        m_parallelChunks.clear();
+        size_t first = 0;
+        for (auto &archetype: m_archetypes)
+        {
+            if ((archetype->mask & mask) != mask)
+                continue;
+            for (size_t chunk = 0; chunk*archetype->capacity < archetype->count; chunk++)
+            {
+                m_parallelChunks.push_back({archetype.get(), chunk, first});
+                first += std::min(archetype->capacity, archetype->count - chunk*archetype->capacity);
+            }
+        }
+
+        if (!chunksPerBatch)
+        {
+            size_t batches = 8*(pool.GetThreadCount()+1);
+            chunksPerBatch = (m_parallelChunks.size() + batches-1) / batches;
+        }
+        pool.ParallelFor(m_parallelChunks.size(), chunksPerBatch, [this, &f](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const ParallelChunk &chunk = m_parallelChunks[i];
+                size_t first = chunk.first;
+                auto withFirst = [&f, first](size_t count, Cs *...arrays)
+                {
+                    f(first, count, arrays...);
+                };
+                __EachChunk<Cs...>(*chunk.archetype, chunk.chunk, withFirst);
+            }
+        });
+    }
+
+    // @brief Same as Each(), the chunks are shared between the threads of the pool (see ParallelEachChunk()).
+    // @note f runs concurrently: it may only write the components it is given.
+    template<typename... Cs, typename F>
+    void ParallelEach(ThreadPool &pool, F &&f, size_t chunksPerBatch = 0)
+    {
+        ParallelEachChunk<Cs...>(pool, [&f](size_t, size_t count, Cs *...arrays)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                f(arrays[i]...);
+            }
+        }, chunksPerBatch);
+    }
+
+    // @brief Number of entities having these components (and maybe others).
+    template<typename... Cs>
+    size_t Count() const
+    {
+        Mask mask = MaskOf<Cs...>();
+        size_t count = 0;
+        for (auto &archetype: m_archetypes)
+        {
+            if ((archetype->mask & mask) == mask)
+                count += archetype->count;
+        }
+        return count;
+    }
+
+    // @brief Number of entities alive.
+    size_t GetCount() const
+    {
+        return m_records.GetCount();
+    }
+};
+
+#endif /* WORLD_HPP */
@@ -0,0 +1,102 @@
+#version 430 core
+
+// One invocation per pooled entity: keeps the ones in view and appends them to their mesh's draw command
+layout(local_size_x = 64) in;
+
+struct Object
+{
+    mat4 model;
+    vec4 sphere;        // Center and radius, in the mesh's space
+    uint command;       // Index of the mesh's DrawElementsIndirectCommand
+    int material;
+    uint padding0;
+    uint padding1;
+};
+
+struct Command
+{
+    uint count;
+    uint instanceCount; // 0 before culling
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;  // First of the command's instance slots
+};
+
+struct Instance
+{
+    mat4 model;
+    int material;
+    int padding0;
+    int padding1;
+    int padding2;
+};
+
+layout(std430, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, binding = 1) buffer Commands { Command commands[]; };
+layout(std430, binding = 2) writeonly buffer Instances { Instance instances[]; };
+
+uniform int objectCount;
+// Pointing inwards, normalized
+uniform vec4 planes[6];
+uniform mat4 viewProjection;
+// Farthest depth of this frame's occluders, drawn in a prepass before the culling, halved at each mip level (see HiZPyramid)
+uniform bool useHiZ;
+uniform sampler2D hiZ;
+uniform vec2 hiZSize;
+uniform int hiZLevels;
+
+bool InFrustum(vec3 center, float radius)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        if (dot(planes[i].xyz, center) + planes[i].w < -radius)
+            return false;
+    }
+    return true;
+}
+
+// @brief Whether the sphere's screen rectangle lies behind the depth pyramid.
+bool Occluded(vec3 center, float radius)
+{
+    vec3 low = vec3(1.0);
+    vec3 high = vec3(-1.0);
+    for (int corner = 0; corner < 8; corner++)
+    {
+        vec3 offset = vec3((corner & 1) != 0 ? radius : -radius, (corner & 2) != 0 ? radius : -radius, (corner & 4) != 0 ? radius : -radius);
+        vec4 clip = viewProjection * vec4(center + offset, 1.0);
+        // Crossing the near plane: can't be tested
+        if (clip.w <= 0.0)
+            return false;
+        vec3 ndc = clip.xyz / clip.w;
+        low = min(low, ndc);
+        high = max(high, ndc);
+    }
+
+    vec2 uvLow = clamp(low.xy*0.5 + 0.5, 0.0, 1.0);
+    vec2 uvHigh = clamp(high.xy*0.5 + 0.5, 0.0, 1.0);
+    float nearest = low.z*0.5 + 0.5;
+    // The level where the rectangle spans 2x2 texels at most
+    vec2 size = (uvHigh - uvLow)*hiZSize;
+    float level = clamp(ceil(log2(max(max(size.x, size.y), 1.0))), 0.0, float(hiZLevels-1));
+    float farthest = max(max(textureLod(hiZ, uvLow, level).r, textureLod(hiZ, vec2(uvHigh.x, uvLow.y), level).r),
+                         max(textureLod(hiZ, vec2(uvLow.x, uvHigh.y), level).r, textureLod(hiZ, uvHigh, level).r));
+    return nearest > farthest;
+}
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uint(objectCount))
+        return;
+
+    Object object = objects[index];
+    vec3 center = (object.model * vec4(object.sphere.xyz, 1.0)).xyz;
+    float scale = max(length(object.model[0].xyz), max(length(object.model[1].xyz), length(object.model[2].xyz)));
+    float radius = object.sphere.w*scale;
+    if (!InFrustum(center, radius) || (useHiZ && Occluded(center, radius)))
+        return;
+
+    uint slot = commands[object.command].baseInstance + atomicAdd(commands[object.command].instanceCount, 1u);
+    instances[slot].model = object.model;
+    instances[slot].material = object.material;
+}
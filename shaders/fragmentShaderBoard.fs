@@ -0,0 +1,27 @@
+#version 330 core
+
+// Compile-time options, injected by Shader::SetDefines() and Shader::AddVariant():
+// TEXTURE_COUNT    1 for the element's texture alone, 2 to blend the layer OVERLAY_LAYER over it
+// OVERLAY_WEIGHT   Share of the overlay in the blend, in percent
+#ifndef TEXTURE_COUNT
+#define TEXTURE_COUNT 1
+#endif
+#ifndef OVERLAY_WEIGHT
+#define OVERLAY_WEIGHT 20
+#endif
+
+out vec4 fragColor;
+
+in vec3 TexCoord;
+
+// Every board image lives in a layer of this array
+uniform sampler2DArray boardSampler;
+
+void main()
+{
+    vec4 color = texture(boardSampler, TexCoord);
+#if TEXTURE_COUNT > 1
+    color = mix(color, texture(boardSampler, vec3(TexCoord.st, OVERLAY_LAYER)), OVERLAY_WEIGHT / 100.0);
+#endif
+    fragColor = color;
+}
@@ -1,12 +0,0 @@
-#version 330 core
-
-out vec4 ground;
-
-in vec2 TexCoord;
-
-uniform sampler2D groundSampler;
-
-void main()
-{
-    ground = texture(groundSampler, TexCoord);
-}
\ No newline at end of file
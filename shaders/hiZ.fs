@@ -0,0 +1,34 @@
+#version 330 core
+
+// One level of the depth pyramid: each texel keeps the farthest depth of the texels it covers in the level below
+out float depth;
+
+// The prepass' depth for level 0, else the level below: the only one visible through the sampler (base = max level)
+uniform sampler2D source;
+uniform bool fromDepth;
+// Of the level being written
+uniform ivec2 targetSize;
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    if (fromDepth)
+    {
+        depth = texelFetch(source, texel, 0).r;
+        return;
+    }
+
+    ivec2 last = textureSize(source, 0) - 1;
+    ivec2 first = min(2*texel, last);
+    // Odd sizes: the last texel also covers the leftover row or column
+    ivec2 end = ivec2(texel.x == targetSize.x-1 ? last.x : first.x+1, texel.y == targetSize.y-1 ? last.y : first.y+1);
+    float farthest = 0.0;
+    for (int y = first.y; y <= end.y; y++)
+    {
+        for (int x = first.x; x <= end.x; x++)
+        {
+            farthest = max(farthest, texelFetch(source, ivec2(x, y), 0).r);
+        }
+    }
+    depth = farthest;
+}
@@ -0,0 +1,45 @@
+#version 330 core
+
+// Stretches the scene rendered at a lower resolution over the whole window (see DynamicResolution)
+out vec4 color;
+
+uniform sampler2D scene;
+// Part of the scene texture holding this frame, in pixels
+uniform vec2 renderSize;
+// Of the window
+uniform vec2 outputSize;
+// 0 is a plain bilinear upscale, up to 1 sharpens the details the lower resolution blurred
+uniform float sharpness;
+
+vec3 Sample(vec2 uv, vec2 low, vec2 high)
+{
+    // Clamped half a texel inside the rendered part: the rest of the texture holds older frames
+    return texture(scene, clamp(uv, low, high)).rgb;
+}
+
+void main()
+{
+    vec2 texel = 1.0 / vec2(textureSize(scene, 0));
+    vec2 low = 0.5*texel;
+    vec2 high = (renderSize - 0.5)*texel;
+    vec2 uv = gl_FragCoord.xy / outputSize * renderSize * texel;
+
+    vec3 center = Sample(uv, low, high);
+    if (sharpness <= 0.0)
+    {
+        color = vec4(center, 1.0);
+        return;
+    }
+
+    // Contrast-adaptive sharpening: an unsharp mask over the 4 neighbours, weaker where the contrast is
+    // already high so that edges don't ring
+    vec3 north = Sample(uv + vec2(0.0, texel.y), low, high);
+    vec3 south = Sample(uv - vec2(0.0, texel.y), low, high);
+    vec3 east = Sample(uv + vec2(texel.x, 0.0), low, high);
+    vec3 west = Sample(uv - vec2(texel.x, 0.0), low, high);
+    vec3 darkest = min(center, min(min(north, south), min(east, west)));
+    vec3 brightest = max(center, max(max(north, south), max(east, west)));
+    vec3 amount = sqrt(clamp(min(darkest, 1.0 - brightest) / max(brightest, vec3(1e-4)), 0.0, 1.0))*sharpness;
+    vec3 sharpened = center + (4.0*center - (north + south + east + west))*0.25*amount;
+    color = vec4(clamp(sharpened, 0.0, 1.0), 1.0);
+}
@@ -0,0 +1,37 @@
+#version 330 core
+
+// Compile-time options, injected by Shader::SetDefines() and Shader::AddVariant():
+// INSTANCED        The model and material come from the instance attributes instead of the uniforms
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in float layer;
+#ifdef INSTANCED
+// Per instance, for the meshes drawn from the MeshPool
+layout(location = 4) in mat4 instanceModel;
+layout(location = 8) in int instanceMaterial;
+#endif
+
+// (s, t, layer of the board texture array)
+out vec3 TexCoord;
+
+uniform mat4 view;
+uniform mat4 perspective;
+#ifndef INSTANCED
+uniform mat4 model;
+// Material of the entity, -1 keeps the layer of the vertices
+uniform int materialLayer;
+#endif
+
+void main()
+{
+#ifdef INSTANCED
+    mat4 entityModel = instanceModel;
+    int material = instanceMaterial;
+#else
+    mat4 entityModel = model;
+    int material = materialLayer;
+#endif
+    gl_Position = perspective * view * entityModel * position;
+    TexCoord = vec3(texCoord, material >= 0 ? float(material) : layer);
+}
@@ -1,16 +0,0 @@
-#version 330 core
-
-layout(location = 0) in vec4 position;
-layout(location = 1) in vec2 texCoord;
-
-out vec2 TexCoord;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 perspective;
-
-void main()
-{
-    gl_Position = perspective *view * model * position;
-    TexCoord = texCoord;
-}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "allocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if COUNT_ALLOCATIONS
+
+static std::atomic<unsigned long> allocationCount {0};
+
+// Only the plain forms are replaced: over-aligned types (std::align_val_t forms) are not counted
+void *operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+unsigned long AllocationCounter::GetCount()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+#else
+
+unsigned long AllocationCounter::GetCount()
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,48 @@
+#include "bounds.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+BoundingSphere BoundingSphere::FromBox(const float min[3], const float max[3])
+{
+    glm::vec3 low = glm::vec3(min[0], min[1], min[2]);
+    glm::vec3 high = glm::vec3(max[0], max[1], max[2]);
+    return {(low + high)*0.5f, glm::length(high - low)*0.5f};
+}
+
+BoundingSphere BoundingSphere::FromBox(const BoundingBox &box)
+{
+    return {(box.min + box.max)*0.5f, glm::length(box.max - box.min)*0.5f};
+}
+
+// @brief The sphere once the model matrix applied, grown by its largest scale so that it still bounds the mesh.
+BoundingSphere BoundingSphere::Transform(const glm::mat4 &model) const
+{
+    glm::vec4 center4 = model*glm::vec4(center, 1.0f);
+    float scale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))});
+    return {glm::vec3(center4), radius*scale};
+}
+
+// @brief Extracts the planes from the rows of the matrix (Gribb & Hartmann).
+Frustum Frustum::FromMatrix(const glm::mat4 &viewProjection)
+{
+    const glm::mat4 &m = viewProjection;
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+    {
+        rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+    }
+
+    Frustum frustum;
+    frustum.planes[0] = rows[3] + rows[0]; // Left
+    frustum.planes[1] = rows[3] - rows[0]; // Right
+    frustum.planes[2] = rows[3] + rows[1]; // Bottom
+    frustum.planes[3] = rows[3] - rows[1]; // Top
+    frustum.planes[4] = rows[3] + rows[2]; // Near
+    frustum.planes[5] = rows[3] - rows[2]; // Far
+    for (glm::vec4 &plane: frustum.planes)
+    {
+        plane = plane / glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
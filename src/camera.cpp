@@ -43,9 +43,9 @@ static glm::mat4 MyLookAt(const glm::vec3 &target, const glm::vec3 &y, const glm
     return base*translate;
 }
 
-Camera::Camera(glm::vec3 &initialPosition,
-               glm::vec3 &initialTarget,
-               glm::vec3 &y,
+Camera::Camera(const glm::vec3 &initialPosition,
+               const glm::vec3 &initialTarget,
+               const glm::vec3 &y,
                float speed,
                float rotationSpeed):
     m_position {initialPosition},
@@ -57,6 +57,17 @@ Camera::Camera(glm::vec3 &initialPosition,
     __SetBase();
 }
 
+// @brief Rebuilds the products of the matrices, if they changed since the last call.
+void Camera::__UpdateCache() const
+{
+    if (m_cacheVersion == m_version)
+        return;
+    m_viewProjection = m_perspective*m_view;
+    m_inverseViewProjection = glm::inverse(m_viewProjection);
+    m_frustum = Frustum::FromMatrix(m_viewProjection);
+    m_cacheVersion = m_version;
+}
+
 // @brief Creates the camera's orthogonal base.
 void Camera::__SetBase()
 {
@@ -74,6 +85,8 @@ glm::mat4 Camera::CreateView()
 {
     m_view = glm::lookAt(m_position, m_target, y);
     // m_view = MyLookAt(m_target, y, m_position);
+    m_viewDirty = false;
+    m_version++;
     return m_view;
 }
 
@@ -92,28 +105,33 @@ glm::mat4 Camera::CreatePerspective(float width, float height, float near, float
     {
         m_fov = fov;
     }
-    float m_width = width;
-    float m_height = height;
-    float m_near = near;
-    float m_far = far;
-    m_perspective = glm::mat4(1.0f);
-    m_perspective = glm::perspective(glm::radians(fov), m_width/m_height, m_near, m_far);
+    m_width = width;
+    m_height = height;
+    m_near = near;
+    m_far = far;
+    m_perspective = glm::perspective(glm::radians(m_fov), m_width/m_height, m_near, m_far);
+    m_version++;
     return m_perspective;
 }
 
 glm::mat4 Camera::ChangeView(const glm::vec3 &newPosition, const glm::vec3 &newTarget)
 {
-    m_view = glm::mat4(1.0f);
-    m_view = glm::lookAt(newPosition, newTarget, y);
-    __SetBase();
-    return m_view;
+    m_position = newPosition;
+    m_target = newTarget;
+    m_viewDirty = true;
+    return UpdateView();
 }
 
+// @brief Rebuilds the view and the base after the camera moved, nothing is done if it did not.
 glm::mat4 Camera::UpdateView()
 {
+    if (!m_viewDirty)
+        return m_view;
     m_view = glm::lookAt(m_position, m_target, y);
     // m_view = MyLookAt(m_target, y, m_position);
     __SetBase();
+    m_viewDirty = false;
+    m_version++;
     return m_view;
 }
 
@@ -122,6 +140,7 @@ void Camera::MoveRight(float timeFrame)
     glm::vec3 delta = m_speed*timeFrame*glm::normalize(glm::cross(m_up, m_direction));
     m_position += delta;
     m_target += delta;
+    m_viewDirty = true;
 }
 
 void Camera::MoveLeft(float timeFrame)
@@ -129,6 +148,7 @@ void Camera::MoveLeft(float timeFrame)
     glm::vec3 delta = m_speed*timeFrame*glm::normalize(glm::cross(m_direction, m_up));
     m_position += delta;
     m_target += delta;
+    m_viewDirty = true;
 }
 
 void Camera::MoveForward(float timeFrame)
@@ -137,6 +157,7 @@ void Camera::MoveForward(float timeFrame)
     glm::vec3 delta = m_speed*timeFrame*glm::normalize(m_direction);
     m_position -= delta;
     m_target -= delta;
+    m_viewDirty = true;
 }
 
 void Camera::MoveBackwards(float timeFrame)
@@ -144,6 +165,7 @@ void Camera::MoveBackwards(float timeFrame)
     glm::vec3 delta = m_speed*timeFrame*glm::normalize(m_direction);
     m_position += delta;
     m_target += delta;
+    m_viewDirty = true;
 }
 
 
@@ -153,6 +175,7 @@ void Camera::SpinView(float yaw, float pitch)
                             sin(glm::radians(pitch)),
                             cos(glm::radians(yaw))*cos(glm::radians(pitch)));
     m_target = m_position - m_direction;
+    m_viewDirty = true;
 }
 
 // @brief Zooms the view in or out depending on the value of fov.
@@ -169,8 +192,11 @@ void Camera::ZoomView(float fov)
     {
         fov = MIN_ANGLE;
     }
+    if (fov == m_fov)
+        return;
     m_fov = fov;
     m_perspective = glm::perspective(glm::radians(m_fov), m_width/m_height, m_near, m_far);
+    m_version++;
 }
 
 
@@ -196,6 +222,7 @@ void Camera::NodView(float frameTime, float limitAngle, bool right)
                             projXZ*sin(-pitch)*cos(yawZ));
     
     m_target = m_position-m_direction;
+    m_viewDirty = true;
 }
 
 
@@ -0,0 +1,152 @@
+#include "dynamicResolution.hpp"
+
+#include <cmath>
+#include <iostream>
+
+DynamicResolution::~DynamicResolution()
+{
+    // Only created along with the program
+    if (m_scene)
+        m_upscale.DeleteProgram();
+}
+
+// @param width, height Of the window's framebuffer.
+// @param minScale, maxScale Bounds of the scale of both axes, maxScale can go above 1 for supersampling.
+// @param targetFrameTime In seconds, 1/144 to hold 144 Hz.
+void DynamicResolution::Create(int width, int height, float minScale, float maxScale, double targetFrameTime)
+{
+    m_minScale = std::max(std::min(minScale, maxScale), 0.1f);
+    m_maxScale = std::max(minScale, maxScale);
+    m_scale = m_maxScale;
+    m_targetFrameTime = targetFrameTime;
+    m_width = width;
+    m_height = height;
+
+    m_scene = Framebuffer::Create();
+    m_color = Texture::Create();
+    m_depth = Texture::Create();
+    __Allocate();
+    for (auto &query: m_queries)
+    {
+        query = Query::Create();
+    }
+    m_emptyArray = VertexArray::Create();
+    m_upscale.CreateShaderProgram("fullScreen.vs", "upscale.fs");
+}
+
+// @brief Reallocates the scene for a new window size, the scale is kept.
+void DynamicResolution::Resize(int width, int height)
+{
+    if (!m_scene || (width == m_width && height == m_height) || !width || !height)
+        return;
+    m_width = width;
+    m_height = height;
+    __Allocate();
+}
+
+// @brief Allocates the scene's textures at the largest scale.
+void DynamicResolution::__Allocate()
+{
+    int width = static_cast<int>(std::ceil(m_maxScale*m_width));
+    int height = static_cast<int>(std::ceil(m_maxScale*m_height));
+
+    glBindTexture(GL_TEXTURE_2D, m_color.Get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, m_depth.Get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_scene.Get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_color.Get(), 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth.Get(), 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "Failed to create the scene framebuffer" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// @param sharpness In [0, 1], only for Sharpen.
+void DynamicResolution::SetUpscale(Upscale filter, float sharpness)
+{
+    m_sharpness = filter == Upscale::Sharpen ? std::max(std::min(sharpness, 1.0f), 0.0f) : 0.0f;
+}
+
+// @brief Reads the timer queries the GPU is done with, and adjusts the scale to the most recent one.
+void DynamicResolution::__ReadQueries()
+{
+    double latest = -1.0;
+    for (int i = 0; i < QUERY_COUNT; i++)
+    {
+        // Oldest first, from frame m_frame-QUERY_COUNT (whose slot this frame reuses) to m_frame-1: the latest
+        // result read wins
+        int query = (m_frame + i) % QUERY_COUNT;
+        if (!m_queryPending[query])
+            continue;
+        GLint available = 0;
+        glGetQueryObjectiv(m_queries[query].Get(), GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(m_queries[query].Get(), GL_QUERY_RESULT, &elapsed);
+        m_queryPending[query] = false;
+        latest = elapsed*1e-9;
+    }
+    if (latest >= 0.0)
+        __Adjust(latest);
+}
+
+// @brief Moves the scale towards the budget: the GPU time follows the pixel count, the square of the scale.
+void DynamicResolution::__Adjust(double gpuTime)
+{
+    m_gpuTime = gpuTime;
+    double budget = HEADROOM*m_targetFrameTime;
+    float scale = m_scale;
+    if (gpuTime > budget)
+        scale *= static_cast<float>(std::sqrt(budget / gpuTime));
+    else if (gpuTime < GROW_THRESHOLD*budget)
+        scale *= 1.0f + GROW_STEP;
+    m_scale = std::max(m_minScale, std::min(scale, m_maxScale));
+}
+
+// @brief Redirects the frame to the scene, at the current scale. The caller clears it and renders as usual.
+void DynamicResolution::Begin()
+{
+    __ReadQueries();
+    glBindFramebuffer(GL_FRAMEBUFFER, m_scene.Get());
+    glViewport(0, 0, GetRenderWidth(), GetRenderHeight());
+
+    // Unless the GPU is QUERY_COUNT frames behind, then this frame goes unmeasured
+    int query = m_frame % QUERY_COUNT;
+    m_measuring = !m_queryPending[query];
+    if (m_measuring)
+    {
+        glBeginQuery(GL_TIME_ELAPSED, m_queries[query].Get());
+        m_queryPending[query] = true;
+    }
+}
+
+// @brief Upscales the scene to the window, which is bound with its full viewport afterwards.
+void DynamicResolution::End()
+{
+    if (m_measuring)
+        glEndQuery(GL_TIME_ELAPSED);
+    m_frame++;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, m_width, m_height);
+    glDisable(GL_DEPTH_TEST);
+    m_upscale.UseProgram();
+    glBindVertexArray(m_emptyArray.Get());
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_color.Get());
+    m_upscale.SetInt("scene", 0);
+    glUniform2f(m_upscale.GetUniformLocation("renderSize"), static_cast<float>(GetRenderWidth()), static_cast<float>(GetRenderHeight()));
+    glUniform2f(m_upscale.GetUniformLocation("outputSize"), static_cast<float>(m_width), static_cast<float>(m_height));
+    glUniform1f(m_upscale.GetUniformLocation("sharpness"), m_sharpness);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glEnable(GL_DEPTH_TEST);
+}
@@ -1,6 +1,6 @@
 #include "entity.hpp"
 
-Entity::Entity(ItemBuffer *buffer, glm::vec3 &translationAxis, glm::vec3 &rotationAxis, float rotationAngle, glm::vec3 &scaleFactor) : 
+Entity::Entity(ItemBuffer *buffer, const glm::vec3 &translationAxis, const glm::vec3 &rotationAxis, float rotationAngle, const glm::vec3 &scaleFactor) : 
     m_buffer {buffer},
     m_origin {translationAxis},
     m_rotationAxis {rotationAxis},
@@ -18,11 +18,13 @@ Entity::Entity(ItemBuffer *buffer, glm::vec3 &translationAxis, glm::vec3 &rotati
 }
 
 // @brief Binds data buffer and draws the entity.
-// @note Relies on glDrawArrays() with GL_TRIANGLES mode.
-void Entity::Draw(int count)
+// @param count Number of indices (or vertices if the buffer has no EBO) to draw, 0 draws the whole buffer.
+// @param bind false when the buffer is already bound, e.g. by the previous entity of the same mesh.
+void Entity::Draw(int count, bool bind)
 {
-    m_buffer->Bind();
-    glDrawArrays(GL_TRIANGLES, 0, count);
+    if (bind)
+        m_buffer->Bind();
+    m_buffer->Draw(count);
 }
 
 void Entity::Paint()
@@ -47,6 +49,14 @@ void Entity::Expulse(float timeFrame, glm::vec3 direction)
 
 }
 
+// @param restitution Ratio of the speed kept after a bounce, in [0, 1].
+void Entity::SetPhysics(float mass, float restitution, float friction)
+{
+    m_mass = mass;
+    m_restitution = restitution;
+    m_friction = friction;
+}
+
 void Entity::ChangeModel(const glm::mat4 &model)
 {
     m_model = model;
@@ -0,0 +1,136 @@
+#include "fileWatcher.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#if WINDOWS_MSVC
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::~FileWatcher()
+{
+#if WINDOWS_MSVC
+    for (void *notification: m_notifications)
+    {
+        FindCloseChangeNotification(notification);
+    }
+#else
+    if (m_inotify >= 0)
+        close(m_inotify);
+#endif
+}
+
+// @brief Starts watching the files of a folder, its subfolders are not.
+// @return The index of the folder, as found in the Changes, or -1 if it can't be watched.
+int FileWatcher::Watch(const std::string &folder)
+{
+#if WINDOWS_MSVC
+    // Editors either rewrite the file or write a copy and rename it over the original
+    HANDLE notification = FindFirstChangeNotificationA(folder.c_str(), FALSE,
+                                                       FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    if (notification == INVALID_HANDLE_VALUE)
+    {
+        std::cout << "Failed to watch " << folder << ": error " << GetLastError() << std::endl;
+        return -1;
+    }
+    std::error_code error;
+    std::unordered_map<std::string, std::filesystem::file_time_type> times;
+    for (auto &entry: std::filesystem::directory_iterator(folder, error))
+    {
+        if (entry.is_regular_file(error))
+            times[entry.path().filename().string()] = entry.last_write_time(error);
+    }
+    if (error)
+    {
+        std::cout << "Failed to watch " << folder << ": " << error.message() << std::endl;
+        FindCloseChangeNotification(notification);
+        return -1;
+    }
+    m_times.push_back(std::move(times));
+    m_notifications.push_back(notification);
+#else
+    if (m_inotify < 0)
+        m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // Editors either rewrite the file or write a copy and rename it over the original
+    int watch = m_inotify < 0 ? -1 : inotify_add_watch(m_inotify, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch < 0)
+    {
+        std::cout << "Failed to watch " << folder << ": " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    m_watches.push_back(watch);
+#endif
+    m_folders.push_back(folder);
+    return static_cast<int>(m_folders.size() - 1);
+}
+
+// @brief Appends the files written since the last call, each one once however many times it was written.
+// @return Whether anything was written in the folders, even if no file is reported (e.g. a subfolder):
+// only then the call may have allocated.
+// @note Doesn't allocate when nothing changed: call it once per frame.
+bool FileWatcher::Poll(std::vector<Change> &changes)
+{
+    bool written = false;
+#if WINDOWS_MSVC
+    for (size_t folder = 0; folder < m_folders.size(); folder++)
+    {
+        // Signaled once the folder is written to, without blocking
+        if (WaitForSingleObject(m_notifications[folder], 0) != WAIT_OBJECT_0)
+            continue;
+        // Re-armed before the scan, a write during the scan is seen by the next Poll()
+        FindNextChangeNotification(m_notifications[folder]);
+        written = true;
+        std::error_code error;
+        for (auto &entry: std::filesystem::directory_iterator(m_folders[folder], error))
+        {
+            if (!entry.is_regular_file(error))
+                continue;
+            std::string file = entry.path().filename().string();
+            std::filesystem::file_time_type time = entry.last_write_time(error);
+            auto known = m_times[folder].find(file);
+            if (known != m_times[folder].end() && known->second == time)
+                continue;
+            m_times[folder][file] = time;
+            __AddChange(changes, static_cast<int>(folder), file.c_str());
+        }
+    }
+#else
+    if (m_inotify < 0)
+        return false;
+    // Aligned for the events read into it
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0)
+    {
+        written = true;
+        for (char *event = buffer; event < buffer + length; )
+        {
+            const inotify_event *notification = reinterpret_cast<const inotify_event *>(event);
+            for (size_t folder = 0; folder < m_watches.size(); folder++)
+            {
+                if (m_watches[folder] == notification->wd && notification->len)
+                    __AddChange(changes, static_cast<int>(folder), notification->name);
+            }
+            event += sizeof(inotify_event) + notification->len;
+        }
+    }
+#endif
+    return written;
+}
+
+void FileWatcher::__AddChange(std::vector<Change> &changes, int folder, const char *file) const
+{
+    for (auto &change: changes)
+    {
+        if (change.folder == folder && change.file == file)
+            return;
+    }
+    changes.push_back({folder, file});
+}
@@ -0,0 +1,68 @@
+#include "frameArena.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+FrameArena::FrameArena(size_t capacity) :
+    m_capacity {capacity}
+{
+    m_block = static_cast<unsigned char *>(std::malloc(m_capacity));
+    if (!m_block)
+        m_capacity = 0;
+}
+
+FrameArena::~FrameArena()
+{
+    Reset();
+    std::free(m_block);
+}
+
+// @brief Serves a request the block can't hold from the heap, until the block grows at Reset().
+void *FrameArena::__AllocateOverflow(size_t bytes, size_t alignment)
+{
+    // The chain link sits in front of the aligned memory
+    size_t header = (sizeof(Overflow) + alignment-1) & ~(alignment-1);
+    if (bytes > std::numeric_limits<size_t>::max() - header - alignment)
+        throw std::bad_alloc();
+    void *memory = std::malloc(header + bytes + alignment);
+    if (!memory)
+        throw std::bad_alloc();
+
+    Overflow *overflow = static_cast<Overflow *>(memory);
+    overflow->next = m_overflow;
+    m_overflow = overflow;
+    m_overflowSize += bytes + alignment;
+
+    size_t address = reinterpret_cast<size_t>(memory) + header;
+    address = (address + alignment-1) & ~(alignment-1);
+    return reinterpret_cast<void *>(address);
+}
+
+// @brief Releases everything allocated since the last Reset().
+// @note Grows the block to the frame's peak if it overflowed, so that the next frames fit in it.
+void FrameArena::Reset()
+{
+    m_peak = GetPeak();
+    while (m_overflow)
+    {
+        Overflow *next = m_overflow->next;
+        std::free(m_overflow);
+        m_overflow = next;
+    }
+
+    if (m_overflowSize)
+    {
+        size_t capacity = std::max(m_capacity*2, m_peak);
+        unsigned char *block = static_cast<unsigned char *>(std::malloc(capacity));
+        if (block)
+        {
+            std::free(m_block);
+            m_block = block;
+            m_capacity = capacity;
+        }
+    }
+    m_used = 0;
+    m_overflowSize = 0;
+}
@@ -0,0 +1,98 @@
+#include "frameScheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+void FrameScheduler::Stats::Add(double frameTime)
+{
+    count++;
+    min = count == 1 ? frameTime : std::min(min, frameTime);
+    max = count == 1 ? frameTime : std::max(max, frameTime);
+    double delta = frameTime - mean;
+    mean += delta / count;
+    m2 += delta*(frameTime - mean);
+}
+
+// @brief Sets the swap interval of the window's context, which must be current.
+// @return The mode in use: AdaptiveVSync falls back to VSync without the swap_control_tear extension.
+FrameScheduler::Mode FrameScheduler::Setup(GLFWwindow *window, Mode mode)
+{
+    m_window = window;
+    m_mode = mode;
+    if (m_mode == Mode::AdaptiveVSync && !glfwExtensionSupported("WGL_EXT_swap_control_tear")
+                                      && !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+    {
+        std::cout << "No swap_control_tear in this context, adaptive vsync falls back to vsync" << std::endl;
+        m_mode = Mode::VSync;
+    }
+    // A negative interval lets late swaps tear (EXT_swap_control_tear)
+    glfwSwapInterval(m_mode == Mode::Uncapped ? 0 : (m_mode == Mode::AdaptiveVSync ? -1 : 1));
+
+    GLFWmonitor *monitor = glfwGetWindowMonitor(window);
+    const GLFWvidmode *videoMode = glfwGetVideoMode(monitor ? monitor : glfwGetPrimaryMonitor());
+    if (videoMode && videoMode->refreshRate > 0)
+        m_refreshPeriod = 1.0 / videoMode->refreshRate;
+
+    m_frameStart = glfwGetTime();
+    m_lastFrameStart = m_frameStart;
+    m_lastPresent = 0.0;
+    return m_mode;
+}
+
+// @brief Sleeps at most until time (in glfwGetTime()'s clock), then spins for the last SLEEP_MARGIN.
+void FrameScheduler::__SleepUntil(double time) const
+{
+    double remaining = time - glfwGetTime();
+    if (remaining > SLEEP_MARGIN)
+        std::this_thread::sleep_for(std::chrono::duration<double>(remaining - SLEEP_MARGIN));
+    while (glfwGetTime() < time)
+    {
+        std::this_thread::yield();
+    }
+}
+
+// @brief Starts a frame, to be called before polling the events.
+void FrameScheduler::BeginFrame()
+{
+    if (m_mode == Mode::LowLatency && m_lastPresent > 0.0)
+    {
+        // The next vblank is a refresh after the last present: start just in time to be done by then
+        double vblank = m_lastPresent + m_refreshPeriod;
+        __SleepUntil(vblank - m_workEstimate - SAFETY_MARGIN);
+    }
+    m_lastFrameStart = m_frameStart;
+    m_frameStart = glfwGetTime();
+    m_deltaTime = static_cast<float>(m_frameStart - m_lastFrameStart);
+}
+
+// @brief Presents the frame and records how long it took.
+void FrameScheduler::EndFrame()
+{
+    if (m_mode == Mode::LowLatency)
+    {
+        // The GPU's share of the frame counts too: without it every frame starts too late and misses its vblank
+        glFinish();
+    }
+    double work = glfwGetTime() - m_frameStart;
+    glfwSwapBuffers(m_window);
+    if (m_mode == Mode::LowLatency)
+    {
+        // Nothing stays queued in the driver: the swap returns at the vblank, the prediction's reference
+        glFinish();
+    }
+    double present = glfwGetTime();
+
+    // Rises at once on a slow frame, decays slowly after it: a missed vblank costs a whole refresh
+    m_workEstimate = work > m_workEstimate ? work : m_workEstimate + 0.1*(work - m_workEstimate);
+    if (m_lastPresent > 0.0)
+    {
+        double frameTime = present - m_lastPresent;
+        m_stats.Add(frameTime);
+        // The monitor's rate is nominal: follows the measured period, skipping the missed vblanks
+        if (m_mode != Mode::Uncapped && frameTime > 0.5*m_refreshPeriod && frameTime < 1.5*m_refreshPeriod)
+            m_refreshPeriod += 0.05*(frameTime - m_refreshPeriod);
+    }
+    m_lastPresent = present;
+}
@@ -0,0 +1,27 @@
+#include "glCaps.hpp"
+
+#include <cstring>
+#include <iostream>
+
+void GLCaps::Load()
+{
+    glGetIntegerv(GL_MAJOR_VERSION, &s_major);
+    glGetIntegerv(GL_MINOR_VERSION, &s_minor);
+    s_parallelShaderCompile = HasExtension("GL_KHR_parallel_shader_compile") || HasExtension("GL_ARB_parallel_shader_compile");
+    s_textureCompressionS3TC = HasExtension("GL_EXT_texture_compression_s3tc");
+    std::cout << "OpenGL " << s_major << "." << s_minor << " context" << std::endl;
+}
+
+// @note Walks the extension list: call it at load time, not per frame.
+bool GLCaps::HasExtension(const char *name)
+{
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; i++)
+    {
+        const char *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension && !std::strcmp(extension, name))
+            return true;
+    }
+    return false;
+}
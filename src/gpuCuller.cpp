@@ -0,0 +1,139 @@
+#include "gpuCuller.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <glm/gtc/type_ptr.hpp>
+
+static_assert(sizeof(GpuCuller::Object) == 96, "Must match the std430 Object of cullInstances.cs");
+static_assert(sizeof(MeshPool::Instance) == 80, "Must match the std430 Instance of cullInstances.cs");
+
+GpuCuller::~GpuCuller()
+{
+    // Only created along with the program
+    if (m_objects)
+        m_program.DeleteProgram();
+    for (auto &readback: m_readbacks)
+    {
+        if (readback.fence)
+            glDeleteSync(readback.fence);
+    }
+}
+
+// @brief Compiles the culling shader, the context must have GLCaps::HasComputeShaders().
+void GpuCuller::Create()
+{
+    m_program.CreateComputeProgram("cullInstances.cs");
+    m_objects = Buffer::Create();
+}
+
+// @brief Also rejects the entities behind the depth pyramid, 0 only tests the frustum.
+// @param texture Farthest depth per texel, halved at each of the levels (see HiZPyramid).
+void GpuCuller::SetHiZ(unsigned int texture, int width, int height, int levels)
+{
+    m_hiZ = texture;
+    m_hiZSize = glm::vec2(static_cast<float>(width), static_cast<float>(height));
+    m_hiZLevels = levels;
+}
+
+// @brief Writes the visible objects into the pool's instance buffer, and their number into its commands.
+// @param objects The command of each object must already be in the pool's command buffer (see MeshPool::UploadCommands()),
+// with no instance, and with room for all its objects from its baseInstance on.
+// @note The program in use changes: the caller binds its own before drawing.
+void GpuCuller::Cull(const Object *objects, size_t count, const Frustum &frustum, const glm::mat4 &viewProjection, MeshPool &pool)
+{
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objects.Get());
+    m_objectCapacity = std::max(m_objectCapacity, count);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, m_objectCapacity*sizeof(Object), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count*sizeof(Object), objects);
+    pool.ReserveInstances(count);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_objects.Get());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, pool.GetCommandBuffer());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, pool.GetInstanceBuffer());
+
+    m_program.UseProgram();
+    m_program.SetInt("objectCount", static_cast<int>(count));
+    glUniform4fv(m_program.GetUniformLocation("planes"), 6, glm::value_ptr(frustum.planes[0]));
+    m_program.SetMatrix4fv("viewProjection", glm::value_ptr(viewProjection));
+    m_program.SetInt("useHiZ", m_hiZ != 0);
+    if (m_hiZ)
+    {
+        // Unit 0 holds the board's texture array
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, m_hiZ);
+        glActiveTexture(GL_TEXTURE0);
+        m_program.SetInt("hiZ", 1);
+        glUniform2f(m_program.GetUniformLocation("hiZSize"), m_hiZSize.x, m_hiZSize.y);
+        m_program.SetInt("hiZLevels", m_hiZLevels);
+    }
+
+    glDispatchCompute(static_cast<GLuint>((count + GROUP_SIZE-1) / GROUP_SIZE), 1, 1);
+    // The draws read what the shader wrote: the commands and the instance attributes
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+// @brief Copies the commands the last Cull() wrote on the GPU, to count their instances a few frames later
+// without waiting for the culling shader (see ReadVisibleCount()).
+// @param testedCount How many objects the last Cull() tested, handed back along with the count.
+// @return false if the GPU is READBACK_COUNT frames behind: this frame goes uncounted.
+bool GpuCuller::QueueVisibleCount(MeshPool &pool, size_t commandCount, size_t testedCount)
+{
+    Readback &readback = m_readbacks[m_nextReadback];
+    if (readback.fence)
+        return false;
+    if (!readback.buffer)
+        readback.buffer = Buffer::Create();
+
+    size_t size = commandCount*sizeof(MeshPool::DrawElementsIndirectCommand);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer.Get());
+    if (readback.capacity < size)
+    {
+        readback.capacity = size;
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_READ);
+    }
+    // The shader wrote the commands through an SSBO
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_COPY_READ_BUFFER, pool.GetCommandBuffer());
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.commandCount = commandCount;
+    readback.testedCount = testedCount;
+    m_nextReadback = (m_nextReadback+1) % READBACK_COUNT;
+    return true;
+}
+
+// @brief Counts the visible objects of the queued copies the GPU is done with, never waiting for it.
+// @param visibleCount, testedCount Receive the counts of the most recent of them.
+// @return false if none is done yet.
+// @note Reads into a buffer kept from one call to the next, which only allocates when the pool grows.
+bool GpuCuller::ReadVisibleCount(size_t &visibleCount, size_t &testedCount)
+{
+    bool read = false;
+    for (int i = 0; i < READBACK_COUNT; i++)
+    {
+        // Oldest first: the latest count read wins
+        Readback &readback = m_readbacks[(m_nextReadback + i) % READBACK_COUNT];
+        if (!readback.fence)
+            continue;
+        // The GPU completes them in order: once one isn't done, the next ones aren't either
+        if (glClientWaitSync(readback.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            break;
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+
+        if (m_readback.size() < readback.commandCount)
+            m_readback.resize(readback.commandCount);
+        glBindBuffer(GL_COPY_READ_BUFFER, readback.buffer.Get());
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, readback.commandCount*sizeof(MeshPool::DrawElementsIndirectCommand),
+                           m_readback.data());
+        visibleCount = 0;
+        for (size_t command = 0; command < readback.commandCount; command++)
+        {
+            visibleCount += m_readback[command].instanceCount;
+        }
+        testedCount = readback.testedCount;
+        read = true;
+    }
+    return read;
+}
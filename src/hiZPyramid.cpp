@@ -0,0 +1,111 @@
+#include "hiZPyramid.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+HiZPyramid::~HiZPyramid()
+{
+    // Only created along with the program
+    if (m_pyramid)
+        m_downsample.DeleteProgram();
+}
+
+// @param width, height Of level 0, a fraction of the window is enough for culling.
+void HiZPyramid::Create(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_levels = 1;
+    while ((width >> m_levels) || (height >> m_levels))
+    {
+        m_levels++;
+    }
+
+    // Depth target of the prepass
+    m_depth = Texture::Create();
+    glBindTexture(GL_TEXTURE_2D, m_depth.Get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    m_prepass = Framebuffer::Create();
+    glBindFramebuffer(GL_FRAMEBUFFER, m_prepass.Get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth.Get(), 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "Failed to create the Hi-Z prepass framebuffer" << std::endl;
+
+    // Every level of the pyramid, each one a render target of the downsampling pass
+    m_pyramid = Texture::Create();
+    glBindTexture(GL_TEXTURE_2D, m_pyramid.Get());
+    for (int level = 0; level < m_levels; level++)
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, GL_R32F, std::max(width >> level, 1), std::max(height >> level, 1), 0, GL_RED, GL_FLOAT, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_levels-1);
+    for (int level = 0; level < m_levels; level++)
+    {
+        m_levelTargets.push_back(Framebuffer::Create());
+        glBindFramebuffer(GL_FRAMEBUFFER, m_levelTargets.back().Get());
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_pyramid.Get(), level);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    m_emptyArray = VertexArray::Create();
+    m_downsample.CreateShaderProgram("fullScreen.vs", "hiZ.fs");
+}
+
+// @brief Redirects the following draws to the depth-only prepass, the occluders are to be drawn next.
+void HiZPyramid::BeginPrepass()
+{
+    glGetIntegerv(GL_VIEWPORT, m_viewport);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_prepass.Get());
+    glViewport(0, 0, m_width, m_height);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+// @brief Builds the pyramid from the prepass, then restores the framebuffer and viewport of before the prepass.
+// @note The program in use changes: the caller binds its own before drawing.
+void HiZPyramid::Build()
+{
+    m_downsample.UseProgram();
+    glBindVertexArray(m_emptyArray.Get());
+    glDisable(GL_DEPTH_TEST);
+    glActiveTexture(GL_TEXTURE1);
+    m_downsample.SetInt("source", 1);
+
+    for (int level = 0; level < m_levels; level++)
+    {
+        int width = std::max(m_width >> level, 1);
+        int height = std::max(m_height >> level, 1);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_levelTargets[level].Get());
+        glViewport(0, 0, width, height);
+        m_downsample.SetInt("fromDepth", level == 0);
+        if (level == 0)
+        {
+            glBindTexture(GL_TEXTURE_2D, m_depth.Get());
+        }
+        else
+        {
+            // Only the level below is visible: reading it while writing this one is no feedback loop
+            glBindTexture(GL_TEXTURE_2D, m_pyramid.Get());
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level-1);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level-1);
+        }
+        glUniform2i(m_downsample.GetUniformLocation("targetSize"), width, height);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, m_pyramid.Get());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_levels-1);
+    glActiveTexture(GL_TEXTURE0);
+    glEnable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(m_viewport[0], m_viewport[1], m_viewport[2], m_viewport[3]);
+}
@@ -1,7 +1,13 @@
+#include <algorithm>
+#include <iterator>
 #include <utility>
 #include <iostream>
 
+#if WINDOWS_MSVC
 #include <glad/glad.h>
+#else
+#include <GL/glew.h>
+#endif
 
 #include "stb_image.h"
 #include "itemBuffer.hpp"
@@ -11,34 +17,149 @@
 // @param sizeBuffer In bytes, the size of the vertexBuffer.
 // @param indices Pointer to the Element Buffer Array (EBO).
 // @param sizeIndices In bytes, the size of indices.
-// @note An EBO can be added (optional).
-ItemBuffer::ItemBuffer(void *vertexBuffer, int sizeBuffer, unsigned int *indices, int sizeIndices)
+// @param indexType GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, the type of indices.
+// @note An EBO can be added (optional), it stays bound to the Vertex Array.
+ItemBuffer::ItemBuffer(const void *vertexBuffer, int sizeBuffer, const void *indices, int sizeIndices, GLenum indexType) :
+    m_size {sizeBuffer},
+    m_indexType {indexType}
 {
-    glGenVertexArrays(1, &m_VA0);
-    glGenBuffers(1, &m_VBO);
+    m_VA0 = VertexArray::Create();
+    m_VBO = Buffer::Create();
 
-    glBindVertexArray(m_VA0);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBindVertexArray(m_VA0.Get());
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO.Get());
     glBufferData(GL_ARRAY_BUFFER, sizeBuffer, vertexBuffer, GL_STATIC_DRAW);
 
     if (indices)
     {
-        glGenBuffers(1, &m_EB0);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeIndices, vertexBuffer, GL_STATIC_DRAW);
+        __AddIndices(indices, sizeIndices);
     }
 
     m_buffer = vertexBuffer;
 }
 
-ItemBuffer::~ItemBuffer()
+// @brief Generates one VBO per stream of the layout and declares its attributes.
+// @param layout Describes the (possibly compact) type of each attribute, see VertexLayout.
+// @param streams The vertices of each stream, as built by layout.Convert().
+// @note No need to call AddVertexAttrib() afterwards.
+ItemBuffer::ItemBuffer(const VertexLayout &layout, const std::vector<std::vector<unsigned char>> &streams,
+                       const void *indices, int sizeIndices, GLenum indexType) :
+    m_indexType {indexType}
 {
-    glDeleteVertexArrays(1, &m_VA0);
-    glDeleteBuffers(1, &m_VBO);
-    glDeleteBuffers(1, &m_EB0);
+    std::vector<const unsigned char *> data;
+    std::vector<size_t> sizes;
+    for (auto &stream: streams)
+    {
+        data.push_back(stream.data());
+        sizes.push_back(stream.size());
+    }
+    __CreateStreams(layout, data.data(), sizes.data());
+
+    if (indices)
+    {
+        __AddIndices(indices, sizeIndices);
+    }
+}
+
+// @brief Uploads a mesh asset straight from its mapped file, without intermediate copies.
+// @note The file can be closed afterwards: its content is on the GPU.
+ItemBuffer::ItemBuffer(const MeshFile &mesh) :
+    m_indexType {mesh.GetHeader().indexType}
+{
+    const MeshFile::Header &header = mesh.GetHeader();
+    // Open() checked that the layout has exactly header.streamCount streams
+    const unsigned char *data[MeshFile::MAX_STREAMS] = {};
+    size_t sizes[MeshFile::MAX_STREAMS] = {};
+    for (unsigned int i = 0; i < header.streamCount; i++)
+    {
+        data[i] = mesh.GetStreamData(i);
+        sizes[i] = mesh.GetStreamSize(i);
+    }
+    __CreateStreams(mesh.GetLayout(), data, sizes);
+    // The mapping does not outlive the mesh file
+    m_buffer = nullptr;
+    SetBounds({glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]),
+               glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2])});
+
+    if (header.indexCount)
+    {
+        __AddIndices(mesh.GetIndexData(), static_cast<int>(mesh.GetIndexSize()));
+    }
+
+    // The submeshes of a level are contiguous (see mesh_converter --lods)
+    const MeshFile::Submesh *submeshes = mesh.GetSubmeshes();
+    std::uint32_t lodCount = 0;
+    for (std::uint32_t i = 0; i < header.submeshCount; i++)
+    {
+        lodCount = std::max(lodCount, submeshes[i].lod+1);
+    }
+    float screenSize = 2.0f*LOD_SCREEN_SIZE;
+    for (std::uint32_t lod = 0; lodCount > 1 && lod < lodCount; lod++)
+    {
+        std::uint32_t first = header.indexCount, end = 0;
+        for (std::uint32_t i = 0; i < header.submeshCount; i++)
+        {
+            if (submeshes[i].lod != lod)
+                continue;
+            first = std::min(first, submeshes[i].firstIndex);
+            end = std::max(end, submeshes[i].firstIndex + submeshes[i].indexCount);
+        }
+        if (first >= end)
+            break;
+        AddLod(static_cast<int>(first), static_cast<int>(end-first), lod ? screenSize : 0.0f);
+        screenSize *= 0.5f;
+    }
+}
+
+// @brief Generates the Vertex Array and one VBO per stream, then declares every attribute of the layout.
+// @note A layout with an empty stream (see VertexLayout::IsValid()) leaves the buffer empty.
+void ItemBuffer::__CreateStreams(const VertexLayout &layout, const unsigned char *const *streams, const size_t *sizes)
+{
+    if (!layout.IsValid())
+    {
+        std::cerr << "Failed to create the vertex streams: the layout has a stream without attributes" << std::endl;
+        return;
+    }
+    m_VA0 = VertexArray::Create();
+    glBindVertexArray(m_VA0.Get());
+
+    std::vector<Buffer> buffers;
+    for (unsigned int i = 0; i < layout.GetStreamCount(); i++)
+    {
+        buffers.push_back(Buffer::Create());
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[i].Get());
+        glBufferData(GL_ARRAY_BUFFER, sizes[i], streams[i], GL_STATIC_DRAW);
+    }
+
+    for (auto &attribute: layout.GetAttributes())
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[attribute.stream].Get());
+        // Packed types always hold 4 components
+        GLint components = attribute.type == GL_INT_2_10_10_10_REV ? 4 : attribute.components;
+        glVertexAttribPointer(attribute.index, components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE,
+                              layout.GetStride(attribute.stream), (void *)static_cast<size_t>(attribute.offset));
+        glEnableVertexAttribArray(attribute.index);
+    }
+
+    m_VBO = std::move(buffers.front());
+    m_streamVBOs.assign(std::make_move_iterator(buffers.begin()+1), std::make_move_iterator(buffers.end()));
+    m_size = static_cast<int>(sizes[0]);
+    m_vertexCount = m_size / layout.GetStride(0);
+    m_buffer = streams[0];
+}
+
+// @brief Generates the EBO and binds it to the Vertex Array.
+void ItemBuffer::__AddIndices(const void *indices, int sizeIndices)
+{
+    m_EB0 = Buffer::Create();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EB0.Get());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeIndices, indices, GL_STATIC_DRAW);
+    m_indexCount = sizeIndices / (m_indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int));
 }
 
 void ItemBuffer::AddVertexAttrib(unsigned int index, unsigned int count, unsigned int stride, unsigned int offset)
 {
+    m_vertexCount = m_size / stride;
     glVertexAttribPointer(index, count, GL_FLOAT, GL_FALSE, stride, (void *)offset);
     glEnableVertexAttribArray(index);
 }
@@ -63,9 +184,9 @@ void ItemBuffer::AddTextureAttrib(int stride)
 
 void ItemBuffer::AddTexture2D(unsigned int &id, const std::string &img, int wrappingParam, int filteringParam)
 {
-    glGenTextures(1, &id);
+    m_textures.push_back(Texture::Create());
+    id = m_textures.back().Get();
     glBindTexture(GL_TEXTURE_2D, id);
-    m_textures.emplace_back(id);
 
     // Wrapping methods
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrappingParam);
@@ -90,12 +211,30 @@ void ItemBuffer::AddTexture2D(unsigned int &id, const std::string &img, int wrap
     stbi_image_free(data);
 }
 
+// @brief Same as AddTexture2D() but the image is decoded and uploaded in the background.
+// @note The texture can be bound right away, it shows a placeholder until loader.Update() uploads it.
+std::shared_future<bool> ItemBuffer::AddTexture2DAsync(TextureLoader &loader, unsigned int &id, const std::string &img, int wrappingParam, int filteringParam)
+{
+    m_textures.push_back(Texture::Create());
+    id = m_textures.back().Get();
+    glBindTexture(GL_TEXTURE_2D, id);
+
+    // Wrapping methods
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrappingParam);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrappingParam);
+    // Filtering methods
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filteringParam);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filteringParam);
+
+    return loader.Load(id, img);
+}
+
 void ItemBuffer::BindTextures()
 {
     for (int i=0; i<m_textures.size() && i<MAX_ACTIVE_TEXTURE; i++)
     {
         glActiveTexture(GL_TEXTURE0+i);
-        glBindTexture(GL_TEXTURE_2D, m_textures.at(i));
+        glBindTexture(GL_TEXTURE_2D, m_textures.at(i).Get());
     }
     
 }
@@ -104,5 +243,54 @@ void ItemBuffer::BindTextures()
 // @note Rely exclusively on glBindVertexArray().
 void ItemBuffer::Bind()
 {
-    glBindVertexArray(m_VA0);
+    glBindVertexArray(m_VA0.Get());
+}
+
+// @brief Appends the next coarser level of detail, level 0 being the full mesh.
+// @param screenSize Share of the viewport's height under which this level is drawn, smaller than the previous level's.
+void ItemBuffer::AddLod(int firstIndex, int indexCount, float screenSize)
+{
+    m_lods.push_back({firstIndex, indexCount, screenSize});
+}
+
+// @brief Picks the level of detail for a mesh covering screenSize of the viewport's height.
+// @param current The level drawn last frame: the mesh only switches once it is hysteresis (a ratio) past the
+// threshold, so that a mesh right at a threshold does not pop between two levels every frame.
+int ItemBuffer::SelectLod(float screenSize, int current, float hysteresis) const
+{
+    int count = static_cast<int>(m_lods.size());
+    int lod = std::min(std::max(current, 0), std::max(count-1, 0));
+    while (lod+1 < count && screenSize < m_lods[lod+1].screenSize*(1.0f - hysteresis))
+    {
+        lod++;
+    }
+    while (lod > 0 && screenSize > m_lods[lod].screenSize*(1.0f + hysteresis))
+    {
+        lod--;
+    }
+    return lod;
+}
+
+// @brief Draws one level of detail of the buffer, which must be bound and indexed.
+void ItemBuffer::DrawLod(int lod)
+{
+    Lod level = GetLod(lod);
+    size_t indexSize = m_indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+    glDrawElements(GL_TRIANGLES, level.indexCount, m_indexType, (void *)(level.firstIndex*indexSize));
+}
+
+// @brief Draws the buffer, which must be bound.
+// @param count Number of indices (or vertices if the buffer has no EBO) to draw, 0 draws the whole buffer.
+// @note Relies on glDrawElements() with GL_TRIANGLES mode, or on glDrawArrays() without indices.
+void ItemBuffer::Draw(int count)
+{
+    if (IsIndexed())
+    {
+        // Level 0 comes first, the simplified levels after it
+        glDrawElements(GL_TRIANGLES, count ? count : GetLod(0).indexCount, m_indexType, nullptr);
+    }
+    else
+    {
+        glDrawArrays(GL_TRIANGLES, 0, count ? count : m_vertexCount);
+    }
 }
@@ -1,12 +1,40 @@
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <cassert>
+#include <cmath>
 
 #include "shader.hpp"
 #include "camera.hpp"
 #include "itemBuffer.hpp"
 #include "entity.hpp"
 #include "packet.hpp"
+#include "threadPool.hpp"
+#include "textureLoader.hpp"
+#include "textureArray.hpp"
+#include "meshBuilder.hpp"
+#include "vertexLayout.hpp"
+#include "meshFile.hpp"
+#include "table.hpp"
+#include "frameArena.hpp"
+#include "allocationCounter.hpp"
+#include "resourceRegistry.hpp"
+#include "world.hpp"
+#include "components.hpp"
+#include "meshPool.hpp"
+#include "glCaps.hpp"
+#include "gpuCuller.hpp"
+#include "frameScheduler.hpp"
+#include "dynamicResolution.hpp"
+#include "shaderCache.hpp"
+#include "fileWatcher.hpp"
+#include "softwareOcclusion.hpp"
+#include "hiZPyramid.hpp"
 
 // turns the header to a .cpp
 #define STB_IMAGE_IMPLEMENTATION
@@ -46,7 +74,6 @@ glm::vec3 cameraTarget = glm::vec3(0.0, 0.0, 2.0);
 Camera cam = Camera(cameraPos, cameraTarget);
 
 float deltaTime = 0.0f;
-float lastTime = 0.0f;
 
 unsigned int width = 800;
 unsigned int height = 500;
@@ -56,22 +83,63 @@ float fov = 45.0f;
 
 double x_mouse, y_mouse;
 
+// Benchmark settings, see ParseArguments()
+bool hiddenWindow = false;
+unsigned long benchmarkFrames = 0;
+unsigned long debrisCount = 0;
+Packet::DrawPath drawPath = Packet::DrawPath::Indirect;
+bool gpuCulling = false;
+enum class Occlusion {None, HiZ, Software} occlusion = Occlusion::None;
+bool lodSelection = true;
+FrameScheduler::Mode framePacing = FrameScheduler::Mode::VSync;
+bool framePacingSet = false; // Benchmarks run uncapped unless asked otherwise
+bool dynamicResolution = false;
+float minResolutionScale = 0.5f;
+float maxResolutionScale = 1.0f;
+double targetRefreshRate = 144.0;
+DynamicResolution::Upscale upscaleFilter = DynamicResolution::Upscale::Bilinear;
+DynamicResolution *sceneResolution = nullptr; // Resized along with the window
+bool shaderCache = true;
+bool hotReload = false;
+// Entities of an occluder mesh with a larger bounding sphere hide the others, see Packet::SetSoftwareOcclusion()
+constexpr float MIN_OCCLUDER_RADIUS = 2.0f;
+
+// Board layout, see ParseArguments()
+#if WINDOWS_MSVC
+std::string tablePath = "C:\\Users\\Elouan THEOT\\Documents\\Programming\\c++\\Flipper_Project_Cpp\\tables\\flipper.table";
+#else
+std::string tablePath = "tables/flipper.table";
+#endif
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
 static void cursor_position_callback(GLFWwindow* window, double xpos, double ypos);
 static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+static void ParseArguments(int argc, char **argv);
 
-int main()
+int main(int argc, char **argv)
 {
+    ParseArguments(argc, argv);
+
     glfwInit();
     const char* glsl_version = "#version 330";
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // GPU culling needs compute shaders: asks for 4.3 first, the rest of the renderer runs on 3.3
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, gpuCulling ? 4 : 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     //glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    if (hiddenWindow)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // Benchmark and training runs don't need to be seen
 
     GLFWwindow* window = glfwCreateWindow(width, height, "LearnOpenGL", NULL, NULL);
+    if (window == NULL && gpuCulling)
+    {
+        std::cout << "No OpenGL 4.3 context, falling back to 3.3 without GPU culling" << std::endl;
+        gpuCulling = false;
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        window = glfwCreateWindow(width, height, "LearnOpenGL", NULL, NULL);
+    }
     if (window == NULL)
     {
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -95,6 +163,7 @@ int main()
 #endif
     // Print out the current version
     std::cout << glGetString(GL_VERSION) << std::endl;
+    GLCaps::Load();
 
     // Window's dimensions
     glViewport(0,0,width,height);
@@ -164,51 +233,151 @@ int main()
     -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
     };
 
-    glm::vec3 positions[] = {
-        glm::vec3(0.0, 0.0, 0.0),
-        glm::vec3(0.5, 0.5, -0.5),
-        glm::vec3(-0.5, 0.7, 0.1),
-        glm::vec3(0.0, -0.5, 0.5),
-        glm::vec3(3.0, -2.0, -14.0),
-        glm::vec3(0.0, 0.0, -4.0),
-        glm::vec3(-5.0, 0.5, -0.5),
-        glm::vec3(5.0, 6.7, -5.0),
-        glm::vec3(-10.0, -17, -5.0),
-        glm::vec3(15.0, 10.0, -10.0),
-    };
-
     // cam is declared global because it needs to be accessed from the callbacks
     cam.CreateView();
     cam.CreatePerspective(800.0f, 600.0f, near, far, fov);
 
-    // Create an item: position, texture, color and more
-    unsigned int woodTexture, smileyTexture;
-    ItemBuffer cubeBuffer = ItemBuffer(rectangles, sizeof(rectangles));
-    // Adds position attribute
-    cubeBuffer.AddVertexAttrib(0, 3, 5*sizeof(float), 0);
-    // Adds texture attribute
-    cubeBuffer.AddVertexAttrib(1, 2, 5*sizeof(float), 3*sizeof(float));
-    // Sets textures
-    cubeBuffer.AddTexture2D(woodTexture, "container.jpg");
-    cubeBuffer.AddTexture2D(smileyTexture, "smiley.jpg");
-    // Binds textures to GL_TEXTURE (16 max) in the same order they were added: e.g., container is bound to GL_TEXTURE0
-    cubeBuffer.BindTextures();
+    // Decodes images in the background
+    ThreadPool pool = ThreadPool();
+
+    // Streams the images within a per-frame time budget, from their GPU-ready cache once it exists
+    TextureLoader textureLoader = TextureLoader(&pool);
+    // Packs all the board's images in one texture array: a single bind for every entity
+    TextureArray boardTextures = TextureArray(&textureLoader);
+    int woodLayer = boardTextures.AddLayer("container.jpg");
+    int smileyLayer = boardTextures.AddLayer("smiley.jpg");
 
     // Create shaders programs
     Shader shader = Shader();
-    shader.CreateShaderProgram("vertexShaderCubes.vs", "fragmentShaderCubes.fs");
+    // Linked programs are kept next to the shaders: the next launches skip compiling them
+    if (shaderCache)
+        ShaderCache::Enable(shader.GetFilePath() + "cache");
+    // The smiley is blended over every cube: compiled in, rather than tested by every fragment
+    if (smileyLayer >= 0)
+        shader.SetDefines(Shader::Define("TEXTURE_COUNT", 2) + Shader::Define("OVERLAY_LAYER", smileyLayer));
+    // Compiled by the driver while the meshes and the table load, the first frame waits for what's left
+    shader.StartShaderProgram("vertexShaderBoard.vs", "fragmentShaderBoard.fs");
+
+    // Create an item: position, texture, layer and more
+    std::vector<float> cubeVertices = TextureArray::AppendLayer(rectangles, 36, 5, woodLayer);
+    // Merges the duplicated corners and orders triangles for the vertex cache
+    MeshBuilder cubeMesh = MeshBuilder(cubeVertices.data(), 36, 6);
+    cubeMesh.Optimize();
+    std::vector<unsigned short> cubeIndices = cubeMesh.GetIndices16();
+
+    // Stores the cube in compact types: 16 bytes per vertex instead of 24
+    VertexLayout cubeLayout = VertexLayout();
+    cubeLayout.Add(0, 3, GL_HALF_FLOAT, false, 0)       // Position
+              .Add(1, 2, GL_UNSIGNED_SHORT, true, 3)    // Texture coordinates in [0, 1]
+              .Add(2, 1, GL_UNSIGNED_BYTE, false, 5);   // Texture array layer
+    std::vector<std::vector<unsigned char>> cubeStreams = cubeLayout.Convert(cubeMesh.GetVertices().data(), cubeMesh.GetVertexCount(), 6);
+    // Owns every mesh, entities only point to them
+    ResourceRegistry<ItemBuffer> meshes = ResourceRegistry<ItemBuffer>();
+    ItemBuffer *cubeBuffer = meshes.Add("cube", cubeLayout, cubeStreams,
+                                        cubeIndices.data(), cubeIndices.size()*sizeof(unsigned short), GL_UNSIGNED_SHORT);
+    // The static meshes are also packed together, to draw many of them at once
+    MeshPool meshPool = MeshPool();
+    BoundingBox cubeBounds = {glm::vec3(-0.5f), glm::vec3(0.5f)};
+    cubeBuffer->SetBounds(cubeBounds);
+    meshPool.Add(cubeBuffer, cubeLayout, cubeStreams, cubeIndices.data(), cubeIndices.size(), GL_UNSIGNED_SHORT,
+                 BoundingSphere::FromBox(cubeBounds));
+
+    // Every object of the game: the board, the balls, the debris...
+    World world = World();
+    // Creates an packet that runs the renderer and the game systems over the world's entities
+    Packet packet = Packet(&cam, &shader, &world);
+    packet.SetTextureArray(&boardTextures);
+    packet.SetThreadPool(&pool);
+
+    // Scratch memory of each frame: render queues, culling results, contact pairs...
+    FrameArena frameArena = FrameArena();
+    packet.SetFrameArena(&frameArena);
+
+    // Reads the board layout and resolves its meshes and materials
+    double tableStart = glfwGetTime();
+    Table table = Table();
+    if (!table.Load(tablePath))
+    {
+        glfwTerminate();
+        return -1;
+    }
+    std::vector<ItemBuffer *> tableMeshes;
+    for (auto &mesh: table.GetMeshes())
+    {
+        // Meshes declared from the same file share its buffers
+        ItemBuffer *buffer = meshes.Find(mesh.source);
+        MeshFile meshFile = MeshFile();
+        if (!buffer && meshFile.Open((std::filesystem::path(table.GetFolder()) / mesh.source).string()))
+        {
+            buffer = meshes.Add(mesh.source, meshFile);
+            meshPool.Add(buffer, meshFile);
+        }
+        // The built-in cube also stands in for the meshes that failed to load
+        tableMeshes.push_back(buffer ? buffer : cubeBuffer);
+    }
+    std::vector<int> tableMaterials;
+    for (auto &material: table.GetMaterials())
+    {
+        tableMaterials.push_back(boardTextures.AddLayer(material.image));
+    }
+    // Every layer is known, the loader can upload them from now on
+    boardTextures.Allocate();
 
-    // First, use the shader program
-    shader.UseProgram();
+    meshPool.Upload();
+    packet.SetMeshPool(&meshPool, drawPath);
 
-    // Creates an packet that contains a camera, a shader and multiple entities (cubes here)
-    Packet packet = Packet(&cam, &shader);
+    // Optional GL 4.3 path: the pooled entities are culled by a compute shader
+    GpuCuller culler = GpuCuller();
+    if (gpuCulling && GLCaps::HasComputeShaders() && packet.GetDrawPath() == Packet::DrawPath::Indirect)
+    {
+        culler.Create();
+        packet.SetGpuCuller(&culler);
+    }
+    else if (gpuCulling)
+    {
+        std::cout << "GPU culling needs compute shaders and the indirect draw path, drawing everything" << std::endl;
+    }
 
-    // Adds all entities here
-    for (size_t i = 0; i < 12; i++)
+    // Occlusion culling: on the GPU it's one more test of the culling shader, on the CPU it culls every path
+    SoftwareOcclusion softwareOcclusion = SoftwareOcclusion();
+    HiZPyramid hiZ = HiZPyramid();
+    if (occlusion == Occlusion::HiZ && packet.GetDrawPath() == Packet::DrawPath::Indirect && culler.IsCreated())
     {
-        Entity cube = Entity(&cubeBuffer, positions[i], positions[i], deltaTime, glm::vec3(0.6));
-        packet.AddEntity(std::move(cube));
+        // A quarter of the window is enough to tell what's hidden
+        hiZ.Create(width/4, height/4);
+        packet.SetHiZOcclusion(&hiZ, MIN_OCCLUDER_RADIUS);
+    }
+    else if (occlusion == Occlusion::HiZ)
+    {
+        std::cout << "Hi-Z occlusion needs GPU culling, drawing the occluded entities" << std::endl;
+    }
+    else if (occlusion == Occlusion::Software)
+    {
+        packet.SetSoftwareOcclusion(&softwareOcclusion, MIN_OCCLUDER_RADIUS);
+    }
+    packet.SetCullingStats(benchmarkFrames != 0);
+    packet.SetLodSelection(lodSelection);
+
+    // Adds all entities at once
+    packet.AddEntities(table, tableMeshes, tableMaterials);
+    std::cout << "Table: " << packet.GetEntityCount() << " entities loaded in "
+              << 1000.0*(glfwGetTime()-tableStart) << " ms" << std::endl;
+
+    // Multiball: B spawns balls at the camera's target, recycling the oldest ones past MAX_BALLS
+    constexpr size_t MAX_BALLS = 256;
+    std::vector<EntityId> balls = std::vector<EntityId>(MAX_BALLS);
+    size_t nextBall = 0;
+    // Spawning balls never allocates: their chunks are already there
+    world.Reserve<Transform, Renderable, RigidBody, Collider>(MAX_BALLS);
+
+    // Stress scene: physics-only entities, updated every frame but never drawn
+    world.Reserve<Transform, RigidBody, Collider>(debrisCount);
+    for (unsigned long i = 0; i < debrisCount; i++)
+    {
+        float spread = static_cast<float>(i % 1000);
+        Transform transform = {glm::vec3(spread, static_cast<float>(i / 1000), -10.0f), 0.0f, y, glm::vec3(0.1f), glm::mat4(1.0f)};
+        RigidBody body = {glm::vec3(0.0f, -1.0f, 0.0f), 1.0f, 0.5f, 0.1f};
+        world.Create(transform, body, Collider {0.1f});
     }
 
     packet.Render(deltaTime);
@@ -223,9 +392,55 @@ int main()
     glfwSetMouseButtonCallback(window, mouse_button_callback); // Sets a callback for mouse's buttons
     glfwSetScrollCallback(window, scroll_callback); // Sets a callback for mouse's buttons
 
+    // Paces the loop from now on, see --frame-pacing
+    FrameScheduler scheduler = FrameScheduler();
+    scheduler.Setup(window, framePacingSet || !benchmarkFrames ? framePacing : FrameScheduler::Mode::Uncapped);
+
+    // Optional offscreen scene whose resolution holds the target rate, see --dynamic-resolution
+    DynamicResolution resolution = DynamicResolution();
+    if (dynamicResolution)
+    {
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        resolution.Create(framebufferWidth, framebufferHeight, minResolutionScale, maxResolutionScale, 1.0/targetRefreshRate);
+        resolution.SetUpscale(upscaleFilter);
+        sceneResolution = &resolution;
+    }
+
+    // Cold (compiled) vs warm (cached) startup, every program is created by now
+    const ShaderCache::Stats &shaderStats = ShaderCache::GetStats();
+    std::cout << "Shaders: " << shaderStats.loaded << " programs loaded from the cache, " << shaderStats.compiled
+              << " compiled, " << 1000.0*shaderStats.seconds << " ms spent waiting on them"
+              << (GLCaps::HasParallelShaderCompile() ? " (parallel compile)" : "") << std::endl;
+
+    // Edits of the shaders and images show up without restarting, see --hot-reload
+    FileWatcher watcher = FileWatcher();
+    std::vector<FileWatcher::Change> changes;
+    Shader *programs[] = {&shader, &hiZ.GetShader(), &culler.GetShader(), &resolution.GetShader()};
+    int shaderFolder = -1;
+    int imageFolder = -1;
+    if (hotReload)
+    {
+        shaderFolder = watcher.Watch(shader.GetFilePath());
+        imageFolder = watcher.Watch(boardTextures.GetImagePath());
+        changes.reserve(16);
+    }
+
+    // Frame-time statistics reported in benchmark mode
+    unsigned long frameCount = 0;
+    double totalFrameTime = 0.0;
+    double benchmarkStart = glfwGetTime();
+    unsigned long frameIndex = 0;
+    double totalUpdateTime = 0.0;
+    double totalRenderTime = 0.0;
+    double totalCulledFraction = 0.0;
+    double totalResolutionScale = 0.0;
+    double totalSceneGpuTime = 0.0;
+
     // Render loop
     while(!glfwWindowShouldClose(window))
     {
+        unsigned long frameAllocations = AllocationCounter::GetCount();
 #if IMGUI
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
@@ -236,19 +451,71 @@ int main()
         ImGui::Text("Hello World");
         ImGui::End();
 #endif
-        deltaTime = glfwGetTime() - lastTime;
+        // In low-latency mode, waits until just before the frame must start: the input is as recent as possible
+        scheduler.BeginFrame();
+        glfwPollEvents();
+        deltaTime = scheduler.GetDeltaTime();
         processInput(window);
-        lastTime = glfwGetTime();
 
+        // Loading and reloading allocate, on this thread and the pool's: their frames are left out of the allocation check
+        bool loading = !textureLoader.IsIdle();
+        if (hotReload)
+        {
+            // Rebuilt in the background, the new programs are swapped in here between two frames
+            changes.clear();
+            loading = watcher.Poll(changes) || loading;
+            for (auto &change: changes)
+            {
+                for (Shader *program: programs)
+                {
+                    if (change.folder == shaderFolder && program->Uses(change.file))
+                        program->StartReload();
+                }
+                if (change.folder == imageFolder && boardTextures.ReloadLayer(change.file))
+                    std::cout << "Reloading " << change.file << std::endl;
+            }
+            for (Shader *program: programs)
+            {
+                loading = program->IsReloading() || loading;
+                program->SwapReloaded();
+            }
+        }
+
+        // Uploads the textures decoded since the last frame, within the loader's time budget
+        textureLoader.Update();
+
+        if (sceneResolution)
+            sceneResolution->Begin();
         glClearColor(0.8f, 0.8f, 0.8f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        for (size_t i = 0; i < 12; i++)
+        if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS)
         {
-            packet.UpdateEntity(glm::vec3(0.0f), glm::vec3(0.0f), deltaTime, glm::vec3(1.0f), i+1);
+            glm::vec3 ballPosition = cam.GetTarget();
+            glm::vec3 ballAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+            glm::vec3 ballScale = glm::vec3(0.2f);
+            packet.DespawnEntity(balls[nextBall]);
+            balls[nextBall] = packet.SpawnEntity(cubeBuffer, ballPosition, ballAxis, 0.0f, ballScale, cam.GetDirection());
+            nextBall = (nextBall+1) % balls.size();
         }
-        
+
+        // Spins every entity around its own axis, then moves the rigid bodies
+        double updateStart = glfwGetTime();
+        packet.UpdateEntity(glm::vec3(0.0f), glm::vec3(0.0f), deltaTime, glm::vec3(1.0f));
+        packet.Simulate(deltaTime);
+        totalUpdateTime += glfwGetTime() - updateStart;
+
+        // Time spent on the main thread recording and submitting the draws
+        double renderStart = glfwGetTime();
         packet.Render(deltaTime);
+        totalRenderTime += glfwGetTime() - renderStart;
+        totalCulledFraction += packet.GetCulledFraction();
+        if (sceneResolution)
+        {
+            totalResolutionScale += sceneResolution->GetScale();
+            totalSceneGpuTime += sceneResolution->GetGpuTime();
+            sceneResolution->End();
+        }
 
 #if IMGUI
         // Rendering
@@ -260,8 +527,52 @@ int main()
         glClear(GL_COLOR_BUFFER_BIT);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 #endif
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        scheduler.EndFrame();
+
+        // Everything the frame allocated in the arena is released at once
+        frameArena.Reset();
+        if (AllocationCounter::IsEnabled())
+        {
+            // Once warmed up, a frame must not touch the heap, unless it loads something
+            frameAllocations = AllocationCounter::GetCount() - frameAllocations;
+            bool checked = frameIndex >= AllocationCounter::WARMUP_FRAMES && !loading;
+            if (checked && frameAllocations)
+                std::cerr << "Frame " << frameIndex << " made " << frameAllocations << " heap allocations" << std::endl;
+            assert(!checked || !frameAllocations);
+        }
+        frameIndex++;
+
+        if (benchmarkFrames)
+        {
+            double now = glfwGetTime();
+            totalFrameTime += now - benchmarkStart;
+            benchmarkStart = now;
+            if (++frameCount == benchmarkFrames)
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+    }
+
+    if (frameCount)
+    {
+        // Parsed by cmake/PGOPipeline.cmake: keep the format
+        std::printf("Average frame time: %.3f ms over %lu frames\n", 1000.0*totalFrameTime/frameCount, frameCount);
+        std::printf("Average update time: %.3f ms for %zu entities\n", 1000.0*totalUpdateTime/frameIndex, world.GetCount());
+        std::printf("Average render time: %.3f ms on the main thread\n", 1000.0*totalRenderTime/frameIndex);
+        const char *paths[] = {"direct", "instanced", "indirect"};
+        std::printf("Draw calls: %u per frame (%s)\n", packet.GetDrawCallCount(), paths[static_cast<int>(packet.GetDrawPath())]);
+        const char *occlusions[] = {"frustum", "frustum + hi-z", "frustum + software occlusion"};
+        std::printf("Culled: %.1f%% of the entities (%s)\n", 100.0*totalCulledFraction/frameIndex, occlusions[static_cast<int>(occlusion)]);
+        const FrameScheduler::Stats &stats = scheduler.GetStats();
+        const char *pacings[] = {"uncapped", "vsync", "adaptive vsync", "low latency"};
+        std::printf("Frame-time variance: %.4f ms^2 (stddev %.3f ms, min %.3f ms, max %.3f ms, %s)\n",
+                    1e6*stats.GetVariance(), 1000.0*std::sqrt(stats.GetVariance()), 1000.0*stats.min, 1000.0*stats.max,
+                    pacings[static_cast<int>(scheduler.GetMode())]);
+        if (sceneResolution)
+        {
+            std::printf("Resolution scale: %.2f on average in [%.2f, %.2f], scene GPU time %.3f ms for a %.0f Hz target\n",
+                        totalResolutionScale/frameIndex, minResolutionScale, maxResolutionScale,
+                        1000.0*totalSceneGpuTime/frameIndex, targetRefreshRate);
+        }
     }
 
 #if IMGUI
@@ -281,6 +592,8 @@ int main()
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
     glViewport(0, 0, width, height);
+    if (sceneResolution)
+        sceneResolution->Resize(width, height);
 }
 
 void processInput(GLFWwindow *window)
@@ -343,3 +656,125 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
     cam.ZoomView(fov);
 }
 
+// @brief Reads the command line options.
+// @note --frames N renders N frames, prints the average frame time and exits (benchmark scene).
+// @note --hidden does not show the window, for benchmark and PGO training runs.
+// @note --table PATH loads another board layout (see Table).
+// @note --entities N adds N physics-only entities to the world, to measure the systems at scale.
+// @note --draw-path direct|instanced|indirect picks how the pooled meshes are submitted (see Packet::DrawPath).
+// @note --gpu-culling asks for a GL 4.3 context and culls the pooled meshes with a compute shader (see GpuCuller).
+// @note --occlusion none|hiz|software also culls the entities hidden behind large ones: hiz along with --gpu-culling,
+// software on the CPU with any draw path (see Packet::SetSoftwareOcclusion()).
+// @note --frame-pacing uncapped|vsync|adaptive|low-latency paces the main loop (see FrameScheduler), vsync by
+// default and uncapped for --frames runs.
+// @note --dynamic-resolution renders the scene offscreen, scaled to hold --target-hz (144 by default) within
+// --resolution-bounds MIN MAX (0.5 1 by default), upscaled with --upscale bilinear|sharpen (see DynamicResolution).
+// @note --no-shader-cache compiles every shader, instead of loading the programs linked by a previous run (see ShaderCache).
+// @note --hot-reload watches shaders/ and img/: edited shaders are rebuilt and edited images decoded again while running.
+// @note --no-lod always draws the full meshes, even those with simplified levels (see mesh_converter --lods).
+void ParseArguments(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--hidden")
+        {
+            hiddenWindow = true;
+        }
+        else if (arg == "--frames" && i+1 < argc)
+        {
+            benchmarkFrames = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--table" && i+1 < argc)
+        {
+            tablePath = argv[++i];
+        }
+        else if (arg == "--entities" && i+1 < argc)
+        {
+            debrisCount = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--gpu-culling")
+        {
+            gpuCulling = true;
+        }
+        else if (arg == "--frame-pacing" && i+1 < argc)
+        {
+            std::string mode = argv[++i];
+            framePacingSet = true;
+            if (mode == "uncapped")
+                framePacing = FrameScheduler::Mode::Uncapped;
+            else if (mode == "vsync")
+                framePacing = FrameScheduler::Mode::VSync;
+            else if (mode == "adaptive")
+                framePacing = FrameScheduler::Mode::AdaptiveVSync;
+            else if (mode == "low-latency")
+                framePacing = FrameScheduler::Mode::LowLatency;
+            else
+                std::cerr << "Unknown frame pacing: " << mode << std::endl;
+        }
+        else if (arg == "--dynamic-resolution")
+        {
+            dynamicResolution = true;
+        }
+        else if (arg == "--resolution-bounds" && i+2 < argc)
+        {
+            minResolutionScale = std::strtof(argv[++i], nullptr);
+            maxResolutionScale = std::strtof(argv[++i], nullptr);
+        }
+        else if (arg == "--target-hz" && i+1 < argc)
+        {
+            targetRefreshRate = std::max(std::strtod(argv[++i], nullptr), 1.0);
+        }
+        else if (arg == "--upscale" && i+1 < argc)
+        {
+            std::string filter = argv[++i];
+            if (filter == "bilinear")
+                upscaleFilter = DynamicResolution::Upscale::Bilinear;
+            else if (filter == "sharpen")
+                upscaleFilter = DynamicResolution::Upscale::Sharpen;
+            else
+                std::cerr << "Unknown upscale filter: " << filter << std::endl;
+        }
+        else if (arg == "--no-shader-cache")
+        {
+            shaderCache = false;
+        }
+        else if (arg == "--hot-reload")
+        {
+            hotReload = true;
+        }
+        else if (arg == "--no-lod")
+        {
+            lodSelection = false;
+        }
+        else if (arg == "--occlusion" && i+1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode == "none")
+                occlusion = Occlusion::None;
+            else if (mode == "hiz")
+                occlusion = Occlusion::HiZ;
+            else if (mode == "software")
+                occlusion = Occlusion::Software;
+            else
+                std::cerr << "Unknown occlusion mode: " << mode << std::endl;
+        }
+        else if (arg == "--draw-path" && i+1 < argc)
+        {
+            std::string path = argv[++i];
+            if (path == "direct")
+                drawPath = Packet::DrawPath::Direct;
+            else if (path == "instanced")
+                drawPath = Packet::DrawPath::Instanced;
+            else if (path == "indirect")
+                drawPath = Packet::DrawPath::Indirect;
+            else
+                std::cerr << "Unknown draw path: " << path << std::endl;
+        }
+        else
+        {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+        }
+    }
+}
+
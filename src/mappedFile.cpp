@@ -0,0 +1,109 @@
+#include "mappedFile.hpp"
+
+#include <utility>
+
+#if WINDOWS_MSVC
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_file, other.m_file);
+        #if WINDOWS_MSVC
+        std::swap(m_mapping, other.m_mapping);
+        #endif
+    }
+    return *this;
+}
+
+// @brief Maps the whole file in memory, read-only.
+// @return false if the file doesn't exist, is empty or can't be mapped.
+bool MappedFile::Open(const std::string &path)
+{
+    Close();
+#if WINDOWS_MSVC
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        Close();
+        return false;
+    }
+    m_data = static_cast<const unsigned char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+    m_file = open(path.c_str(), O_RDONLY);
+    if (m_file < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(m_file, &info) != 0 || info.st_size == 0)
+    {
+        Close();
+        return false;
+    }
+    void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+    m_data = data == MAP_FAILED ? nullptr : static_cast<const unsigned char *>(data);
+    m_size = static_cast<std::size_t>(info.st_size);
+#endif
+    if (!m_data)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close()
+{
+#if WINDOWS_MSVC
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file)
+        CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if (m_data)
+        munmap(const_cast<unsigned char *>(m_data), m_size);
+    if (m_file >= 0)
+        close(m_file);
+    m_file = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
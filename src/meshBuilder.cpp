@@ -0,0 +1,240 @@
+#include "meshBuilder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+
+#include "hash.hpp"
+
+// Tuning of the vertex scores, from Forsyth's "Linear-Speed Vertex Cache Optimisation"
+static constexpr float CACHE_DECAY_POWER = 1.5f;
+static constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+static constexpr float VALENCE_BOOST_SCALE = 2.0f;
+static constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+// @brief How much drawing one more triangle of this vertex is worth.
+// @param cachePosition -1 when the vertex is not in the cache.
+static float
+VertexScore(int cachePosition, unsigned int remainingTriangles, unsigned int cacheSize)
+{
+    if (!remainingTriangles)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+        {
+            // Used by the last triangle: a fixed score so that strips are not favored too much
+            score = LAST_TRIANGLE_SCORE;
+        }
+        else
+        {
+            float scale = 1.0f / (cacheSize-3);
+            score = std::pow(1.0f - (cachePosition-3)*scale, CACHE_DECAY_POWER);
+        }
+    }
+    // Boosts vertices with few triangles left so that they don't get stranded
+    score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+    return score;
+}
+
+// @brief Merges the vertices whose attributes are bitwise identical.
+MeshBuilder::MeshBuilder(const float *vertices, size_t vertexCount, unsigned int stride) :
+    m_stride {stride},
+    m_inputVertexCount {vertexCount}
+{
+    std::unordered_multimap<std::uint64_t, unsigned int> unique;
+    unique.reserve(vertexCount);
+    m_vertices.reserve(vertexCount*stride);
+    m_indices.reserve(vertexCount);
+
+    size_t vertexSize = stride*sizeof(float);
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        const float *vertex = vertices + i*stride;
+        std::uint64_t hash = Hash64(vertex, vertexSize);
+
+        unsigned int index = static_cast<unsigned int>(m_vertices.size()/stride);
+        auto range = unique.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (!std::memcmp(&m_vertices[static_cast<size_t>(it->second)*stride], vertex, vertexSize))
+            {
+                index = it->second;
+                break;
+            }
+        }
+        if (index == m_vertices.size()/stride)
+        {
+            m_vertices.insert(m_vertices.end(), vertex, vertex+stride);
+            unique.emplace(hash, index);
+        }
+        m_indices.push_back(index);
+    }
+}
+
+// @brief Reorders triangles for the post-transform cache, then vertices for the pre-transform cache.
+// @param cacheSize Number of entries of the simulated LRU cache.
+void MeshBuilder::Optimize(unsigned int cacheSize)
+{
+    size_t vertexCount = GetVertexCount();
+    size_t triangleCount = m_indices.size()/3;
+    if (!triangleCount)
+        return;
+
+    // Triangles of each vertex, as offsets in a single array
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index: m_indices)
+    {
+        remaining[index]++;
+    }
+    std::vector<unsigned int> firstTriangle(vertexCount+1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        firstTriangle[v+1] = firstTriangle[v] + remaining[v];
+    }
+    std::vector<unsigned int> vertexTriangles(m_indices.size());
+    std::vector<unsigned int> filled(firstTriangle.begin(), firstTriangle.end()-1);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            unsigned int v = m_indices[3*t+k];
+            vertexTriangles[filled[v]++] = static_cast<unsigned int>(t);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        vertexScore[v] = VertexScore(-1, remaining[v], cacheSize);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> drawn(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        triangleScore[t] = vertexScore[m_indices[3*t]] + vertexScore[m_indices[3*t+1]] + vertexScore[m_indices[3*t+2]];
+    }
+
+    std::vector<unsigned int> output;
+    output.reserve(m_indices.size());
+    // The LRU cache holds 3 extra entries: the vertices of the triangle being added
+    std::vector<unsigned int> cache;
+    cache.reserve(cacheSize+3);
+    size_t scanCursor = 0;
+    long best = static_cast<long>(std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+
+    while (best >= 0)
+    {
+        drawn[best] = true;
+        unsigned int triangle[3] = {m_indices[3*best], m_indices[3*best+1], m_indices[3*best+2]};
+        output.insert(output.end(), triangle, triangle+3);
+
+        // Moves the triangle's vertices to the front of the cache
+        std::vector<unsigned int> newCache(triangle, triangle+3);
+        for (unsigned int v: cache)
+        {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                newCache.push_back(v);
+        }
+        for (unsigned int v: triangle)
+        {
+            remaining[v]--;
+        }
+
+        // Updates the scores of the vertices that entered, moved in or left the cache
+        for (size_t i = 0; i < newCache.size(); i++)
+        {
+            unsigned int v = newCache[i];
+            cachePosition[v] = i < cacheSize ? static_cast<int>(i) : -1;
+            float newScore = VertexScore(cachePosition[v], remaining[v], cacheSize);
+            float delta = newScore - vertexScore[v];
+            vertexScore[v] = newScore;
+            for (unsigned int j = firstTriangle[v]; j < firstTriangle[v+1]; j++)
+            {
+                triangleScore[vertexTriangles[j]] += delta;
+            }
+        }
+        if (newCache.size() > cacheSize)
+            newCache.resize(cacheSize);
+        cache.swap(newCache);
+
+        // The next triangle is the best one touching the cache...
+        best = -1;
+        float bestScore = -1.0f;
+        for (unsigned int v: cache)
+        {
+            for (unsigned int j = firstTriangle[v]; j < firstTriangle[v+1]; j++)
+            {
+                unsigned int t = vertexTriangles[j];
+                if (!drawn[t] && triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+        // ...or, when the cache is exhausted, the next triangle not drawn yet
+        if (best < 0)
+        {
+            while (scanCursor < triangleCount && drawn[scanCursor])
+                scanCursor++;
+            if (scanCursor < triangleCount)
+                best = static_cast<long>(scanCursor);
+        }
+    }
+
+    m_indices.swap(output);
+    __ReorderVertices();
+}
+
+// @brief Renumbers the vertices in the order the indices first reference them.
+void MeshBuilder::__ReorderVertices()
+{
+    const unsigned int unassigned = ~0u;
+    std::vector<unsigned int> remap(GetVertexCount(), unassigned);
+    std::vector<float> vertices;
+    vertices.reserve(m_vertices.size());
+    unsigned int next = 0;
+    for (unsigned int &index: m_indices)
+    {
+        if (remap[index] == unassigned)
+        {
+            remap[index] = next++;
+            vertices.insert(vertices.end(), m_vertices.begin() + static_cast<size_t>(index)*m_stride,
+                            m_vertices.begin() + static_cast<size_t>(index+1)*m_stride);
+        }
+        index = remap[index];
+    }
+    m_vertices.swap(vertices);
+}
+
+// @brief Number of vertex shader invocations a FIFO post-transform cache of the given size needs.
+unsigned int MeshBuilder::CountTransforms(const unsigned int *indices, size_t indexCount, unsigned int cacheSize)
+{
+    std::vector<unsigned int> fifo(cacheSize, ~0u);
+    size_t head = 0;
+    unsigned int misses = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        if (std::find(fifo.begin(), fifo.end(), indices[i]) == fifo.end())
+        {
+            fifo[head] = indices[i];
+            head = (head+1) % cacheSize;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+// @brief Average cache miss ratio: vertex shader invocations per triangle (3 without any reuse, 0.5 at best).
+float MeshBuilder::ComputeACMR(const unsigned int *indices, size_t indexCount, unsigned int cacheSize)
+{
+    if (indexCount < 3)
+        return 0.0f;
+    return static_cast<float>(CountTransforms(indices, indexCount, cacheSize)) / (indexCount/3);
+}
@@ -0,0 +1,202 @@
+#include "meshFile.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+// Every table starts on this boundary
+static constexpr std::uint64_t TABLE_ALIGNMENT = 16;
+
+static std::uint64_t
+Align(std::uint64_t offset)
+{
+    return (offset + TABLE_ALIGNMENT-1) & ~(TABLE_ALIGNMENT-1);
+}
+
+// @return Whether [offset, offset+bytes) lies in a file of the given size, without overflowing.
+static bool
+Fits(std::uint64_t offset, std::uint64_t bytes, std::uint64_t size)
+{
+    return offset <= size && bytes <= size - offset;
+}
+
+// @brief Maps a mesh file and checks it before anything reads it: every table lies inside the file,
+// the attributes match the streams' strides, and the submeshes and indices stay within the mesh.
+// @return false for a truncated or corrupt file, nothing of it is used then.
+bool MeshFile::Open(const std::string &path)
+{
+    m_header = nullptr;
+    if (!m_file.Open(path))
+    {
+        std::cerr << "Failed to open the mesh: " << path << std::endl;
+        return false;
+    }
+
+    const Header *header = reinterpret_cast<const Header *>(m_file.GetData());
+    std::uint64_t size = m_file.GetSize();
+    std::uint64_t indexSize = 0;
+    bool valid = size >= sizeof(Header) && header->magic == MAGIC && header->version == VERSION
+              && header->vertexCount && header->streamCount && header->streamCount <= MAX_STREAMS
+              && (header->indexType == GL_UNSIGNED_SHORT || header->indexType == GL_UNSIGNED_INT)
+              && Fits(header->attributeOffset, static_cast<std::uint64_t>(header->attributeCount)*sizeof(Attribute), size)
+              && Fits(header->submeshOffset, static_cast<std::uint64_t>(header->submeshCount)*sizeof(Submesh), size);
+    for (unsigned int i = 0; valid && i < header->streamCount; i++)
+    {
+        valid = header->streamStrides[i] && Fits(header->streamOffsets[i],
+                                                 static_cast<std::uint64_t>(header->vertexCount)*header->streamStrides[i], size);
+    }
+    if (valid)
+    {
+        indexSize = static_cast<std::uint64_t>(header->indexCount)*(header->indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+        valid = Fits(header->indexOffset, indexSize, size);
+    }
+
+    // The layout rebuilt from the attributes must give every stream, with the stride it was written with
+    const Attribute *attributes = valid ? reinterpret_cast<const Attribute *>(m_file.GetData() + header->attributeOffset) : nullptr;
+    for (std::uint32_t i = 0; valid && i < header->attributeCount; i++)
+    {
+        valid = attributes[i].stream < header->streamCount && attributes[i].components >= 1 && attributes[i].components <= 4;
+    }
+    if (valid)
+    {
+        m_header = header;
+        VertexLayout layout = GetLayout();
+        valid = layout.GetStreamCount() == header->streamCount;
+        for (unsigned int i = 0; valid && i < header->streamCount; i++)
+        {
+            valid = layout.GetStride(i) == header->streamStrides[i];
+        }
+    }
+
+    const Submesh *submeshes = valid ? GetSubmeshes() : nullptr;
+    for (std::uint32_t i = 0; valid && i < header->submeshCount; i++)
+    {
+        valid = static_cast<std::uint64_t>(submeshes[i].firstIndex) + submeshes[i].indexCount <= header->indexCount;
+    }
+    // Out of range indices would make the GPU read past the vertex buffers
+    for (std::uint32_t i = 0; valid && i < header->indexCount; i++)
+    {
+        std::uint32_t index = header->indexType == GL_UNSIGNED_SHORT ? reinterpret_cast<const std::uint16_t *>(GetIndexData())[i]
+                                                                    : reinterpret_cast<const std::uint32_t *>(GetIndexData())[i];
+        valid = index < header->vertexCount;
+    }
+
+    if (!valid)
+    {
+        std::cerr << "Invalid mesh file: " << path << std::endl;
+        m_header = nullptr;
+        m_file.Close();
+        return false;
+    }
+    return true;
+}
+
+// @brief Rebuilds the vertex layout the streams were written with.
+VertexLayout MeshFile::GetLayout() const
+{
+    VertexLayout layout;
+    const Attribute *attributes = reinterpret_cast<const Attribute *>(m_file.GetData() + m_header->attributeOffset);
+    for (std::uint32_t i = 0; i < m_header->attributeCount; i++)
+    {
+        // Offsets are recomputed by Add(), in the same order as when written
+        layout.Add(attributes[i].index, attributes[i].components, attributes[i].type, attributes[i].normalized != 0,
+                   0, attributes[i].stream);
+    }
+    return layout;
+}
+
+// @brief Writes a mesh file, indices are narrowed to 16 bits when the vertex count allows it.
+// @param streams Vertices of each stream, as built by layout.Convert().
+// @param boundsMin, boundsMax Object space bounding box, 3 floats each.
+bool MeshFile::Write(const std::string &path, const VertexLayout &layout,
+                     const std::vector<std::vector<unsigned char>> &streams, size_t vertexCount,
+                     const std::vector<unsigned int> &indices, const std::vector<Submesh> &submeshes,
+                     const float *boundsMin, const float *boundsMax)
+{
+    if (streams.size() > MAX_STREAMS)
+    {
+        std::cerr << "Too many vertex streams for a mesh file: " << streams.size() << std::endl;
+        return false;
+    }
+    if (!layout.IsValid() || streams.size() != layout.GetStreamCount())
+    {
+        std::cerr << "Failed to write " << path << ": every vertex stream needs an attribute" << std::endl;
+        return false;
+    }
+
+    Header header {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.vertexCount = static_cast<std::uint32_t>(vertexCount);
+    header.indexCount = static_cast<std::uint32_t>(indices.size());
+    header.indexType = vertexCount <= 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    header.attributeCount = static_cast<std::uint32_t>(layout.GetAttributes().size());
+    header.streamCount = static_cast<std::uint32_t>(streams.size());
+    header.submeshCount = static_cast<std::uint32_t>(submeshes.size());
+    for (int c = 0; c < 3; c++)
+    {
+        header.boundsMin[c] = boundsMin[c];
+        header.boundsMax[c] = boundsMax[c];
+    }
+
+    std::vector<Attribute> attributes;
+    for (auto &attribute: layout.GetAttributes())
+    {
+        attributes.push_back({attribute.index, attribute.components, attribute.type, attribute.normalized ? 1u : 0u, attribute.stream});
+    }
+
+    std::vector<unsigned char> indexData;
+    if (header.indexType == GL_UNSIGNED_SHORT)
+    {
+        std::vector<unsigned short> narrow(indices.begin(), indices.end());
+        indexData.assign(reinterpret_cast<const unsigned char *>(narrow.data()),
+                         reinterpret_cast<const unsigned char *>(narrow.data() + narrow.size()));
+    }
+    else
+    {
+        indexData.assign(reinterpret_cast<const unsigned char *>(indices.data()),
+                         reinterpret_cast<const unsigned char *>(indices.data() + indices.size()));
+    }
+
+    std::uint64_t offset = Align(sizeof(Header));
+    header.attributeOffset = offset;
+    offset = Align(offset + attributes.size()*sizeof(Attribute));
+    header.submeshOffset = offset;
+    offset = Align(offset + submeshes.size()*sizeof(Submesh));
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        header.streamStrides[i] = layout.GetStride(static_cast<unsigned int>(i));
+        header.streamOffsets[i] = offset;
+        offset = Align(offset + streams[i].size());
+    }
+    header.indexOffset = offset;
+
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cerr << "Failed to write the mesh: " << path << std::endl;
+            return false;
+        }
+        auto writeAt = [&file](std::uint64_t position, const void *data, size_t size)
+        {
+            static const char zeros[TABLE_ALIGNMENT] = {};
+            file.write(zeros, position - static_cast<std::uint64_t>(file.tellp()));
+            file.write(static_cast<const char *>(data), size);
+        };
+        writeAt(0, &header, sizeof(Header));
+        writeAt(header.attributeOffset, attributes.data(), attributes.size()*sizeof(Attribute));
+        writeAt(header.submeshOffset, submeshes.data(), submeshes.size()*sizeof(Submesh));
+        for (size_t i = 0; i < streams.size(); i++)
+        {
+            writeAt(header.streamOffsets[i], streams[i].data(), streams[i].size());
+        }
+        writeAt(header.indexOffset, indexData.data(), indexData.size());
+        if (!file)
+            return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    return !error;
+}
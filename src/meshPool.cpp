@@ -0,0 +1,205 @@
+#include "meshPool.hpp"
+#include "itemBuffer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+// @brief Appends a mesh to the pool of its layout, creating that pool if it's the first mesh of the layout.
+// @param mesh The buffer the mesh is otherwise drawn with, the key Find() looks it up by.
+// @param indexType GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, the pool stores 32-bit indices either way.
+// @param bounds Sphere around the mesh's vertices, for culling.
+// @return false if the mesh has no indices or its layout an empty stream, it then keeps being drawn on its own.
+bool MeshPool::Add(const ItemBuffer *mesh, const VertexLayout &layout, const unsigned char *const *streams, const size_t *sizes,
+                   const void *indices, size_t indexCount, GLenum indexType, const BoundingSphere &bounds)
+{
+    if (!indices || !indexCount || !layout.IsValid())
+        return false;
+    if (m_ranges.count(mesh))
+        return true;
+
+    unsigned int index = 0;
+    while (index < m_layouts.size() && !m_layouts[index].layout.IsCompatible(layout))
+    {
+        index++;
+    }
+    if (index == m_layouts.size())
+    {
+        m_layouts.emplace_back();
+        m_layouts.back().layout = layout;
+        m_layouts.back().streams.resize(layout.GetStreamCount());
+    }
+    LayoutBuffers &buffers = m_layouts[index];
+
+    // The mesh's levels of detail are ranges of its indices
+    std::vector<Range> ranges;
+    for (int lod = 0; lod < mesh->GetLodCount(); lod++)
+    {
+        ItemBuffer::Lod level = mesh->GetLod(lod);
+        ranges.push_back({index, static_cast<unsigned int>(buffers.indices.size() + level.firstIndex),
+                          static_cast<unsigned int>(level.indexCount),
+                          static_cast<int>(buffers.vertexCount), bounds});
+    }
+    for (unsigned int stream = 0; stream < layout.GetStreamCount(); stream++)
+    {
+        buffers.streams[stream].insert(buffers.streams[stream].end(), streams[stream], streams[stream] + sizes[stream]);
+    }
+    buffers.vertexCount += static_cast<unsigned int>(sizes[0] / layout.GetStride(0));
+
+    // Indices stay relative to the mesh: baseVertex offsets them at draw time
+    buffers.indices.reserve(buffers.indices.size() + indexCount);
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        buffers.indices.push_back(indexType == GL_UNSIGNED_SHORT ? static_cast<const unsigned short *>(indices)[i]
+                                                                 : static_cast<const unsigned int *>(indices)[i]);
+    }
+    m_ranges.emplace(mesh, std::move(ranges));
+    return true;
+}
+
+// @param streams The vertices of each stream, as built by layout.Convert().
+bool MeshPool::Add(const ItemBuffer *mesh, const VertexLayout &layout, const std::vector<std::vector<unsigned char>> &streams,
+                   const void *indices, size_t indexCount, GLenum indexType, const BoundingSphere &bounds)
+{
+    std::vector<const unsigned char *> data;
+    std::vector<size_t> sizes;
+    for (auto &stream: streams)
+    {
+        data.push_back(stream.data());
+        sizes.push_back(stream.size());
+    }
+    return Add(mesh, layout, data.data(), sizes.data(), indices, indexCount, indexType, bounds);
+}
+
+// @note The file can be closed afterwards: the pool keeps a copy until Upload().
+bool MeshPool::Add(const ItemBuffer *mesh, const MeshFile &file)
+{
+    const MeshFile::Header &header = file.GetHeader();
+    // Open() checked that the layout has exactly header.streamCount streams
+    const unsigned char *data[MeshFile::MAX_STREAMS] = {};
+    size_t sizes[MeshFile::MAX_STREAMS] = {};
+    for (unsigned int i = 0; i < header.streamCount; i++)
+    {
+        data[i] = file.GetStreamData(i);
+        sizes[i] = file.GetStreamSize(i);
+    }
+    return Add(mesh, file.GetLayout(), data, sizes, file.GetIndexData(), header.indexCount, header.indexType,
+               BoundingSphere::FromBox(header.boundsMin, header.boundsMax));
+}
+
+// @brief Creates the buffers of every layout and uploads the meshes added so far.
+void MeshPool::Upload()
+{
+    m_instanceBuffer = Buffer::Create();
+    m_commandBuffer = Buffer::Create();
+    for (auto &buffers: m_layouts)
+    {
+        buffers.vertexArray = VertexArray::Create();
+        glBindVertexArray(buffers.vertexArray.Get());
+
+        for (auto &stream: buffers.streams)
+        {
+            buffers.vertexBuffers.push_back(Buffer::Create());
+            glBindBuffer(GL_ARRAY_BUFFER, buffers.vertexBuffers.back().Get());
+            glBufferData(GL_ARRAY_BUFFER, stream.size(), stream.data(), GL_STATIC_DRAW);
+        }
+        for (auto &attribute: buffers.layout.GetAttributes())
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, buffers.vertexBuffers[attribute.stream].Get());
+            // Packed types always hold 4 components
+            GLint components = attribute.type == GL_INT_2_10_10_10_REV ? 4 : attribute.components;
+            glVertexAttribPointer(attribute.index, components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE,
+                                  buffers.layout.GetStride(attribute.stream), (void *)static_cast<size_t>(attribute.offset));
+            glEnableVertexAttribArray(attribute.index);
+        }
+
+        buffers.indexBuffer = Buffer::Create();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indexBuffer.Get());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffers.indices.size()*sizeof(unsigned int), buffers.indices.data(), GL_STATIC_DRAW);
+
+        // One model matrix and material per instance
+        glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer.Get());
+        for (unsigned int i = 0; i < 5; i++)
+        {
+            glEnableVertexAttribArray(INSTANCE_LOCATION + i);
+            glVertexAttribDivisor(INSTANCE_LOCATION + i, 1);
+        }
+        __SetInstancePointers(0);
+
+        // Everything is on the GPU now
+        buffers.streams = std::vector<std::vector<unsigned char>>();
+        buffers.indices = std::vector<unsigned int>();
+    }
+    glBindVertexArray(0);
+}
+
+// @brief Points the instance attributes of the bound Vertex Array at the given instance.
+// @note The instance buffer must be bound to GL_ARRAY_BUFFER.
+void MeshPool::__SetInstancePointers(size_t firstInstance)
+{
+    size_t offset = firstInstance*sizeof(Instance);
+    for (unsigned int column = 0; column < 4; column++)
+    {
+        glVertexAttribPointer(INSTANCE_LOCATION + column, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              (void *)(offset + column*4*sizeof(float)));
+    }
+    glVertexAttribIPointer(INSTANCE_LOCATION + 4, 1, GL_INT, sizeof(Instance), (void *)(offset + offsetof(Instance, material)));
+}
+
+// @brief Streams this frame's instances, the buffer only grows.
+void MeshPool::UploadInstances(const Instance *instances, size_t count)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer.Get());
+    m_instanceCapacity = std::max(m_instanceCapacity, count);
+    // Orphans the previous frame's storage instead of waiting for the GPU to be done with it
+    glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity*sizeof(Instance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count*sizeof(Instance), instances);
+}
+
+// @brief Makes room for count instances without uploading them, for the instances written by the GPU.
+void MeshPool::ReserveInstances(size_t count)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer.Get());
+    m_instanceCapacity = std::max(m_instanceCapacity, count);
+    glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity*sizeof(Instance), nullptr, GL_STREAM_DRAW);
+}
+
+// @brief Streams this frame's commands to the GL_DRAW_INDIRECT_BUFFER, for MultiDraw().
+void MeshPool::UploadCommands(const DrawElementsIndirectCommand *commands, size_t count)
+{
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer.Get());
+    m_commandCapacity = std::max(m_commandCapacity, count);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, m_commandCapacity*sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, count*sizeof(DrawElementsIndirectCommand), commands);
+}
+
+// @brief Binds the Vertex Array of one layout, the following draws read its meshes.
+void MeshPool::Bind(unsigned int layout)
+{
+    glBindVertexArray(m_layouts[layout].vertexArray.Get());
+}
+
+// @brief Submits count commands of the indirect buffer at once, for the bound layout.
+// @note Needs GLCaps::HasMultiDrawIndirect(), DrawLoop() does the same otherwise.
+void MeshPool::MultiDraw(size_t firstCommand, size_t count)
+{
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer.Get());
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void *)(firstCommand*sizeof(DrawElementsIndirectCommand)),
+                               static_cast<GLsizei>(count), 0);
+}
+
+// @brief Same as MultiDraw() with one instanced draw per command, for the contexts without indirect draws.
+// @note Without ARB_base_instance, the instance attributes are moved to each command's first instance instead.
+void MeshPool::DrawLoop(const DrawElementsIndirectCommand *commands, size_t count)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer.Get());
+    for (size_t i = 0; i < count; i++)
+    {
+        const DrawElementsIndirectCommand &command = commands[i];
+        __SetInstancePointers(command.baseInstance);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                                          (void *)(command.firstIndex*sizeof(unsigned int)),
+                                          command.instanceCount, command.baseVertex);
+    }
+    __SetInstancePointers(0);
+}
@@ -0,0 +1,152 @@
+#include "meshSimplifier.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+MeshSimplifier::MeshSimplifier(const float *vertices, size_t vertexCount, unsigned int stride) :
+    m_vertices {vertices},
+    m_vertexCount {vertexCount},
+    m_stride {stride},
+    m_extent {0.0f}
+{
+    if (!vertexCount)
+        return;
+    float low[3] = {vertices[0], vertices[1], vertices[2]};
+    float high[3] = {vertices[0], vertices[1], vertices[2]};
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            low[c] = std::min(low[c], vertices[v*stride+c]);
+            high[c] = std::max(high[c], vertices[v*stride+c]);
+        }
+    }
+    m_extent = std::max(high[0]-low[0], std::max(high[1]-low[1], high[2]-low[2]));
+}
+
+// @brief Merges the vertices of each cell of a grid into one.
+// @param indices A triangle list over the vertices.
+// @param cellSize Side of a cell, in the units of the positions.
+// @return The triangles left, without the degenerate and duplicate ones.
+std::vector<unsigned int> MeshSimplifier::Cluster(const std::vector<unsigned int> &indices, float cellSize) const
+{
+    // Only the vertices used by the triangles take part
+    auto cellOf = [&](unsigned int vertex)
+    {
+        const float *position = m_vertices + static_cast<size_t>(vertex)*m_stride;
+        std::uint64_t key = 0;
+        for (int c = 0; c < 3; c++)
+        {
+            // 21 bits per axis, wide enough for 2M cells along the mesh
+            std::int64_t cell = static_cast<std::int64_t>(std::floor(position[c] / cellSize));
+            key = (key << 21) | (static_cast<std::uint64_t>(cell) & 0x1FFFFF);
+        }
+        return key;
+    };
+
+    struct Cell
+    {
+        float sum[3];
+        unsigned int count;
+        unsigned int representative;
+        float distance;
+    };
+    std::unordered_map<std::uint64_t, Cell> cells;
+    for (unsigned int vertex: indices)
+    {
+        Cell &cell = cells.emplace(cellOf(vertex), Cell {{0.0f, 0.0f, 0.0f}, 0, vertex, 0.0f}).first->second;
+        const float *position = m_vertices + static_cast<size_t>(vertex)*m_stride;
+        for (int c = 0; c < 3; c++)
+            cell.sum[c] += position[c];
+        cell.count++;
+    }
+    // The vertex closest to the average keeps the cell's attributes
+    for (auto &entry: cells)
+        entry.second.distance = INFINITY;
+    std::vector<unsigned int> remap(m_vertexCount, 0);
+    for (unsigned int vertex: indices)
+    {
+        Cell &cell = cells[cellOf(vertex)];
+        const float *position = m_vertices + static_cast<size_t>(vertex)*m_stride;
+        float distance = 0.0f;
+        for (int c = 0; c < 3; c++)
+        {
+            float delta = position[c] - cell.sum[c]/cell.count;
+            distance += delta*delta;
+        }
+        if (distance < cell.distance)
+        {
+            cell.distance = distance;
+            cell.representative = vertex;
+        }
+    }
+    for (unsigned int vertex: indices)
+    {
+        remap[vertex] = cells[cellOf(vertex)].representative;
+    }
+
+    std::vector<unsigned int> simplified;
+    // Triangles are compared on all 3 indices: the hash only spreads them, whatever the vertex count
+    using Triangle = std::array<unsigned int, 3>;
+    struct TriangleHash
+    {
+        size_t operator()(const Triangle &triangle) const
+        {
+            std::uint64_t key = (static_cast<std::uint64_t>(triangle[0]) << 32 | triangle[1])
+                              ^ static_cast<std::uint64_t>(triangle[2])*0x9E3779B97F4A7C15ull;
+            return std::hash<std::uint64_t>()(key);
+        }
+    };
+    std::unordered_set<Triangle, TriangleHash> seen;
+    for (size_t i = 0; i+2 < indices.size(); i += 3)
+    {
+        unsigned int a = remap[indices[i]], b = remap[indices[i+1]], c = remap[indices[i+2]];
+        if (a == b || b == c || c == a)
+            continue;
+        // Same triangle whatever its first corner, the winding is kept
+        unsigned int first = std::min(a, std::min(b, c));
+        unsigned int second = first == a ? b : (first == b ? c : a);
+        unsigned int third = first == a ? c : (first == b ? a : b);
+        if (!seen.insert({first, second, third}).second)
+            continue;
+        simplified.insert(simplified.end(), {a, b, c});
+    }
+    return simplified;
+}
+
+// @brief Looks for the finest grid that leaves at most ratio of the triangles.
+// @param ratio In ]0, 1[, 0.5 halves the triangle count.
+// @return The original indices if no grid simplifies the mesh without collapsing it entirely.
+std::vector<unsigned int> MeshSimplifier::Simplify(const std::vector<unsigned int> &indices, float ratio) const
+{
+    size_t target = static_cast<size_t>(ratio*indices.size()/3);
+    if (m_extent <= 0.0f || !target)
+        return indices;
+
+    // Bisection on the cell size, the triangle count falls as the cells grow
+    float fine = m_extent / 1024.0f;
+    float coarse = m_extent;
+    std::vector<unsigned int> best = indices;
+    for (int iteration = 0; iteration < 16; iteration++)
+    {
+        float cellSize = std::sqrt(fine*coarse);
+        std::vector<unsigned int> candidate = Cluster(indices, cellSize);
+        if (candidate.size()/3 > target)
+        {
+            fine = cellSize;
+        }
+        else
+        {
+            coarse = cellSize;
+            if (!candidate.empty())
+                best = std::move(candidate);
+        }
+    }
+    return best;
+}
@@ -1,99 +1,623 @@
 #include "packet.hpp"
+#include "glCaps.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iostream>
 #include <utility>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-Packet::Packet(Camera *cam, Shader *shader) : 
+// @brief Builds the components of an entity of the board.
+// @param rotationAngle in degrees, like the table's.
+// @param occluder Only for closed meshes that fill their bounding box, see Table::Mesh.
+static EntityId CreateBoardEntity(World &world, ItemBuffer *mesh, int material, const glm::vec3 &position,
+                                  const glm::vec3 &rotationAxis, float rotationAngle, const glm::vec3 &scale,
+                                  const RigidBody &body, bool occluder = false)
+{
+    Transform transform = {position, glm::radians(rotationAngle), rotationAxis, scale, glm::mat4(1.0f)};
+    transform.UpdateModel();
+    // Sphere around the unit cube the meshes are modeled in
+    Collider collider = {0.5f*glm::length(scale)};
+    return world.Create(transform, Renderable {mesh, material, 0, occluder}, body, collider);
+}
+
+Packet::Packet(Camera *cam, Shader *shader, World *world) :
+    m_world {world},
     m_camera {cam},
     m_shader {shader}
 {
+    // Compiled alongside the loading, the pool's first draw waits for what's left
+    m_instancedVariant = m_shader->AddVariant(Shader::Define("INSTANCED"));
+    m_shader->StartVariant(m_instancedVariant);
 }
 
 Packet::~Packet()
 {
 }
 
-void Packet::AddEntity(Entity &entity)
+// @brief Adds the entity to the world, it is copied into components.
+// @return The id of the new entity, the Entity itself can be dropped.
+EntityId Packet::AddEntity(Entity &entity)
+{
+    RigidBody body = {glm::vec3(0.0f), entity.GetMass(), entity.GetRestitution(), entity.GetFriction()};
+    EntityId id = CreateBoardEntity(*m_world, entity.GetBuffer(), entity.GetMaterial(), entity.GetOrigin(),
+                                    entity.GetRotationAxis(), entity.GetRotationAngle(), entity.GetScale(), body);
+    m_tableEntities.push_back(id);
+    return id;
+}
+
+// @brief Adds every entity of a table at once, their chunks are allocated upfront.
+// @param meshes The buffer of each mesh of the table, in the table's order.
+// @param materials The texture array layer of each material of the table, in the table's order.
+void Packet::AddEntities(const Table &table, const std::vector<ItemBuffer *> &meshes, const std::vector<int> &materials)
+{
+    m_world->Reserve<Transform, Renderable, RigidBody, Collider>(table.GetPlacements().size());
+    m_tableEntities.reserve(m_tableEntities.size() + table.GetPlacements().size());
+    for (auto &placement: table.GetPlacements())
+    {
+        glm::vec3 position = glm::vec3(placement.position[0], placement.position[1], placement.position[2]);
+        glm::vec3 axis = glm::vec3(placement.rotationAxis[0], placement.rotationAxis[1], placement.rotationAxis[2]);
+        glm::vec3 scale = glm::vec3(placement.scale[0], placement.scale[1], placement.scale[2]);
+        RigidBody body = {glm::vec3(0.0f), placement.mass, placement.restitution, placement.friction};
+        m_tableEntities.push_back(CreateBoardEntity(*m_world, meshes[placement.mesh], materials[placement.material],
+                                                    position, axis, placement.rotationAngle, scale, body,
+                                                    table.GetMeshes()[placement.mesh].occluder));
+    }
+}
+
+// @brief Adds an entity while the game runs: balls, particles...
+// @param rotationAngle in degrees.
+// @note Spawned entities are not part of the table: MoveEntity() and UpdateEntity() only reach them with index 0.
+EntityId Packet::SpawnEntity(ItemBuffer *mesh, const glm::vec3 &position, const glm::vec3 &rotationAxis, float rotationAngle,
+                             const glm::vec3 &scale, const glm::vec3 &velocity)
+{
+    RigidBody body = {velocity, 1.0f, 0.5f, 0.0f};
+    return CreateBoardEntity(*m_world, mesh, -1, position, rotationAxis, rotationAngle, scale, body);
+}
+
+// @brief Destroys an entity in O(1), its id and every copy of it become invalid.
+// @return false if the entity was already destroyed.
+bool Packet::DespawnEntity(EntityId id)
+{
+    return m_world->Destroy(id);
+}
+
+// @brief Shares one texture array between all entities: bound once per frame instead of per entity.
+// @note The shader samples it through "boardSampler", see fragmentShaderBoard.fs.
+void Packet::SetTextureArray(TextureArray *textures)
+{
+    m_textures = textures;
+}
+
+// @brief Scratch memory for the per-frame data of the packet, such as the render queue.
+// @note The arena must be reset once the frame is rendered, see main.cpp.
+void Packet::SetFrameArena(FrameArena *arena)
+{
+    m_arena = arena;
+}
+
+// @brief Runs the systems over all entities across the threads of the pool, instead of on the calling thread.
+// @note Only from PARALLEL_THRESHOLD entities on, see update_benchmark for the scaling.
+void Packet::SetThreadPool(ThreadPool *pool)
+{
+    m_pool = pool;
+}
+
+// @brief Draws the meshes of the pool with one draw for many entities.
+// @param path Indirect falls back to Instanced when the context has no multi-draw indirect.
+// @note Only with a frame arena, which holds the per-frame instances and commands.
+void Packet::SetMeshPool(MeshPool *meshes, DrawPath path)
 {
-    m_entities.emplace_back(entity);
+    m_meshPool = meshes;
+    m_drawPath = path;
+    if (m_drawPath == DrawPath::Indirect && !GLCaps::HasMultiDrawIndirect())
+    {
+        std::cout << "No multi-draw indirect in this context, the mesh pool is drawn with a loop of instanced draws" << std::endl;
+        m_drawPath = DrawPath::Instanced;
+    }
+}
+
+// @brief Culls the pooled meshes on the GPU before the multi-draw, nullptr draws all of them.
+// @note Only with the Indirect path: the culler writes the indirect commands.
+void Packet::SetGpuCuller(GpuCuller *culler)
+{
+    m_culler = culler;
+}
+
+// @brief Skips the entities hidden behind the large ones, tested on the CPU before the draws are sorted.
+// @param minOccluderRadius Entities of an occluder mesh whose bounding sphere is at least this large are rasterized
+// as occluders.
+// @note Only meshes with bounds (see ItemBuffer::SetBounds()) are occluders or culled, the others are always drawn.
+void Packet::SetSoftwareOcclusion(SoftwareOcclusion *occlusion, float minOccluderRadius)
+{
+    m_softwareOcclusion = occlusion;
+    m_minOccluderRadius = minOccluderRadius;
+}
+
+// @brief Same as SetSoftwareOcclusion() on the GPU: the occluders are drawn in a depth prepass, whose pyramid
+// the GPU culler tests the pooled entities against.
+// @note Only along with SetGpuCuller().
+void Packet::SetHiZOcclusion(HiZPyramid *pyramid, float minOccluderRadius)
+{
+    m_hiZ = pyramid;
+    m_minOccluderRadius = minOccluderRadius;
+}
+
+// @brief Counts the culled entities, see GetCulledFraction().
+// @note With GPU culling, the counts are read back a few frames late rather than waiting for the culling shader.
+void Packet::SetCullingStats(bool enabled)
+{
+    m_cullingStats = enabled;
+}
+
+// @brief Draws the meshes with simplified levels (see ItemBuffer::AddLod()) coarser as they get smaller on screen.
+// @note Only with a frame arena, where the levels are picked while recording.
+void Packet::SetLodSelection(bool enabled)
+{
+    m_lodSelection = enabled;
+}
+
+// @brief Transform of a table entity from its 1-based index, nullptr if there's no such entity.
+Transform *Packet::__GetTableTransform(int index)
+{
+    if (index <= 0)
+        return nullptr;
+    size_t position = static_cast<size_t>(index) - 1;
+    return position < m_tableEntities.size() ? m_world->Get<Transform>(m_tableEntities[position]) : nullptr;
 }
 
 // @brief Modifies each entity's pose from scratch according to the given model matrix.
-// @param index Starts at 1. If not specified, all entities will be moved the same.
+// @param index Starts at 1, only for the entities of the table. If not specified, all entities will be moved the same.
 // @note Erases the current entity's model.
 void Packet::MoveEntity(glm::mat4 &model, int index)
 {
     if(index)
     {
-        if (index < m_entities.size()) 
-            m_entities.at(index-1).ChangeModel(model);
+        if (Transform *transform = __GetTableTransform(index))
+            transform->model = model;
     }
     else
     {
-        for (auto &ent: m_entities)
+        m_world->Each<Transform>([&model](Transform &transform)
         {
-            ent.ChangeModel(model);
-        }
+            transform.model = model;
+        });
     }
 }
 
 // @brief Updates each entity's pose upon the current one according to the given vectors.
-// @param index Starts at 1. If not specified, all entities will be moved the same.
+// @param index Starts at 1, only for the entities of the table. If not specified, all entities will be moved the same.
 // @note Updates the entity's members as well, so you can call it only when you want to update.
-void Packet::UpdateEntity(glm::vec3 &translationAxis, glm::vec3 &rotationAxis, float rotationAngle, glm::vec3 &scaleFactor, int index)
+void Packet::UpdateEntity(const glm::vec3 &translationAxis, const glm::vec3 &rotationAxis, float rotationAngle, const glm::vec3 &scaleFactor, int index)
 {
+    auto update = [&](Transform &transform)
+    {
+        transform.position += translationAxis;
+        transform.rotationAxis += rotationAxis;
+        transform.rotationAngle += rotationAngle;
+        transform.scale *= scaleFactor;
+        transform.UpdateModel();
+    };
+
     if(index)
     {
-        if (index < m_entities.size()) 
-            m_entities.at(index-1).UpdateModel(translationAxis, rotationAxis, rotationAngle, scaleFactor);
+        if (Transform *transform = __GetTableTransform(index))
+            update(*transform);
+    }
+    else if (m_pool && m_world->Count<Transform>() >= PARALLEL_THRESHOLD)
+    {
+        m_world->ParallelEach<Transform>(*m_pool, update);
     }
     else
     {
-        for (auto &ent: m_entities)
+        m_world->Each<Transform>(update);
+    }
+}
+
+// @brief Moves the rigid bodies along their velocity, slowed down by their friction.
+void Packet::Simulate(float timeFrame)
+{
+    auto integrate = [timeFrame](Transform &transform, RigidBody &body)
+    {
+        if (body.velocity == glm::vec3(0.0f))
+            return;
+        transform.position += body.velocity*timeFrame;
+        body.velocity *= std::max(0.0f, 1.0f - body.friction*timeFrame);
+        transform.UpdateModel();
+    };
+
+    if (m_pool && m_world->Count<Transform, RigidBody>() >= PARALLEL_THRESHOLD)
+        m_world->ParallelEach<Transform, RigidBody>(*m_pool, integrate);
+    else
+        m_world->Each<Transform, RigidBody>(integrate);
+}
+
+// @brief Records a draw command per renderable entity in the frame arena.
+// @param count Set to the number of commands.
+// @note Each chunk of the world writes its own slice of the commands: the threads never share a cache line
+// but at the slices' edges, and the commands come out merged.
+Packet::DrawCommand *Packet::__RecordCommands(size_t &count)
+{
+    count = m_world->Count<Transform, Renderable>();
+    DrawCommand *commands = m_arena->Allocate<DrawCommand>(count);
+    // Share of the viewport's height covered by a sphere of radius 1 at distance 1
+    const glm::mat4 &view = m_camera->GetViewMat();
+    float projectedRadius = m_camera->GetPerspectiveMat()[1][1];
+    bool selectLod = m_lodSelection;
+    auto record = [=](size_t first, size_t chunkCount, Transform *transforms, Renderable *renderables)
+    {
+        for (size_t i = 0; i < chunkCount; i++)
         {
-            ent.UpdateModel(translationAxis, rotationAxis, rotationAngle, scaleFactor);
+            Renderable &renderable = renderables[i];
+            const BoundingBox *box = renderable.mesh->GetBounds();
+            if (selectLod && box && renderable.mesh->GetLodCount() > 1)
+            {
+                BoundingSphere sphere = BoundingSphere::FromBox(*box).Transform(transforms[i].model);
+                float distance = glm::length(glm::vec3(view*glm::vec4(sphere.center, 1.0f)));
+                float screenSize = distance > sphere.radius ? sphere.radius*projectedRadius/distance : 1.0f;
+                renderable.lod = renderable.mesh->SelectLod(screenSize, renderable.lod, LOD_HYSTERESIS);
+            }
+            commands[first+i] = {renderable.mesh, renderable.material, selectLod ? renderable.lod : 0, &transforms[i].model,
+                                 renderable.occluder};
         }
+    };
+
+    if (m_pool && count >= PARALLEL_THRESHOLD)
+    {
+        m_world->ParallelEachChunk<Transform, Renderable>(*m_pool, record);
+    }
+    else
+    {
+        size_t first = 0;
+        m_world->EachChunk<Transform, Renderable>([&](size_t chunkCount, Transform *transforms, Renderable *renderables)
+        {
+            record(first, chunkCount, transforms, renderables);
+            first += chunkCount;
+        });
     }
+    return commands;
 }
 
-void Packet::CheckContact(float timeFrame, double x_mouse, double y_mouse)
+// @brief Sorts the commands by mesh, level of detail then material, so that the replay binds each of them once.
+// @return The sorted commands: either the given ones, or a copy in the frame arena.
+// @note Large queues are sorted in runs across the pool, then merged pairwise, also in parallel.
+Packet::DrawCommand *Packet::__SortCommands(DrawCommand *commands, size_t count)
+{
+    auto drawsBefore = [](const DrawCommand &a, const DrawCommand &b)
+    {
+        if (a.mesh != b.mesh)
+            return std::less<ItemBuffer *>()(a.mesh, b.mesh);
+        if (a.lod != b.lod)
+            return a.lod < b.lod;
+        return a.material < b.material;
+    };
+
+    if (!m_pool || count < PARALLEL_THRESHOLD)
+    {
+        std::sort(commands, commands+count, drawsBefore);
+        return commands;
+    }
+
+    size_t runs = 8*(m_pool->GetThreadCount()+1);
+    size_t runSize = (count + runs-1) / runs;
+    m_pool->ParallelFor(count, runSize, [&](size_t begin, size_t end)
+    {
+        std::sort(commands+begin, commands+end, drawsBefore);
+    });
+
+    DrawCommand *merged = m_arena->Allocate<DrawCommand>(count);
+    for (size_t width = runSize; width < count; width *= 2)
+    {
+        m_pool->ParallelFor(count, 2*width, [&](size_t begin, size_t end)
+        {
+            size_t middle = std::min(begin+width, end);
+            std::merge(commands+begin, commands+middle, commands+middle, commands+end, merged+begin, drawsBefore);
+        });
+        std::swap(commands, merged);
+    }
+    return commands;
+}
+
+// @brief Only meshes flagged as occluders (see Table::Mesh) may hide others: they are rasterized as their box.
+// Among them, only the entities large on their own: testing against many small ones costs more than it culls.
+bool Packet::__IsOccluder(const DrawCommand &command) const
+{
+    const BoundingBox *box = command.mesh->GetBounds();
+    return command.occluder && box && BoundingSphere::FromBox(*box).Transform(*command.model).radius >= m_minOccluderRadius;
+}
+
+// @brief Removes the commands of the entities outside of the frustum or hidden behind the occluders.
+// @return The number of commands kept, at the front of the array in their original order.
+size_t Packet::__CullSoftware(DrawCommand *commands, size_t count)
+{
+    const Frustum &frustum = m_camera->GetFrustum();
+    m_softwareOcclusion->Begin(m_camera->GetViewProjection());
+    for (size_t i = 0; i < count; i++)
+    {
+        if (__IsOccluder(commands[i]))
+            m_softwareOcclusion->AddOccluder(*commands[i].model, *commands[i].mesh->GetBounds());
+    }
+    m_softwareOcclusion->Finish();
+
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const BoundingBox *box = commands[i].mesh->GetBounds();
+        if (box)
+        {
+            BoundingSphere sphere = BoundingSphere::FromBox(*box).Transform(*commands[i].model);
+            if (!frustum.Intersects(sphere.center, sphere.radius) || m_softwareOcclusion->IsOccluded(sphere.center, sphere.radius))
+                continue;
+        }
+        commands[kept++] = commands[i];
+    }
+    m_testedCount = count;
+    m_culledCount = count - kept;
+    return kept;
+}
+
+// @brief Draws the occluders into the depth prepass and builds the pyramid the GPU culler tests against.
+// @note Binds the board's program again, the uniforms of the frame are kept.
+void Packet::__BuildHiZ(const DrawCommand *commands, size_t count)
 {
-    for (auto &entity: m_entities)
+    m_hiZ->BeginPrepass();
+    int modelLocation = m_shader->GetUniformLocation("model");
+    const ItemBuffer *bound = nullptr;
+    for (size_t i = 0; i < count; i++)
     {
-        if (entity.IsReachable(x_mouse, y_mouse, m_camera->GetTarget().z))
+        if (!__IsOccluder(commands[i]))
+            continue;
+        if (commands[i].mesh != bound)
         {
-            entity.UpdateModel(m_camera->GetDirection(), glm::vec3(0.0f), timeFrame, glm::vec3(1.0f));
+            commands[i].mesh->Bind();
+            bound = commands[i].mesh;
         }
-        
+        m_shader->SetMatrix4fv(modelLocation, glm::value_ptr(*commands[i].model));
+        commands[i].mesh->Draw();
     }
-    
+    m_hiZ->Build();
+    m_shader->UseProgram();
+    m_culler->SetHiZ(m_hiZ->GetTexture(), m_hiZ->GetWidth(), m_hiZ->GetHeight(), m_hiZ->GetLevelCount());
+}
+
+// @brief Draws the commands whose mesh is in the pool: each run of the same mesh and level is one instanced command,
+// submitted with one multi-draw per layout of the pool (or a loop over the commands, see DrawPath).
+// @param commands Sorted by mesh.
+void Packet::__DrawPooled(const DrawCommand *commands, size_t count)
+{
+    struct Run
+    {
+        const MeshPool::Range *range;
+        size_t begin;
+        size_t end;
+    };
+
+    auto startsRun = [commands](size_t i)
+    {
+        return !i || commands[i].mesh != commands[i-1].mesh || commands[i].lod != commands[i-1].lod;
+    };
+    size_t runCount = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (startsRun(i))
+            runCount++;
+    }
+    Run *runs = m_arena->Allocate<Run>(runCount);
+    size_t pooledRuns = 0;
+    size_t instanceCount = 0;
+    for (size_t i = 0, run = 0; i < count; i++)
+    {
+        if (startsRun(i))
+        {
+            runs[run++] = {m_meshPool->Find(commands[i].mesh, commands[i].lod), i, i};
+            pooledRuns += runs[run-1].range != nullptr;
+        }
+        runs[run-1].end = i+1;
+        instanceCount += runs[run-1].range != nullptr;
+    }
+    if (!pooledRuns)
+        return;
+
+    // The commands of a layout are contiguous, for its multi-draw. With GPU culling, the commands start empty
+    // and the entities are objects to test, the compute shader writes the instances
+    bool gpuCulling = m_culler && m_drawPath == DrawPath::Indirect;
+    MeshPool::Instance *instances = gpuCulling ? nullptr : m_arena->Allocate<MeshPool::Instance>(instanceCount);
+    GpuCuller::Object *objects = gpuCulling ? m_arena->Allocate<GpuCuller::Object>(instanceCount) : nullptr;
+    MeshPool::DrawElementsIndirectCommand *indirect = m_arena->Allocate<MeshPool::DrawElementsIndirectCommand>(pooledRuns);
+    size_t *layoutEnds = m_arena->Allocate<size_t>(m_meshPool->GetLayoutCount());
+    size_t commandCount = 0;
+    GLuint instance = 0;
+    for (unsigned int layout = 0; layout < m_meshPool->GetLayoutCount(); layout++)
+    {
+        for (size_t run = 0; run < runCount; run++)
+        {
+            const MeshPool::Range *range = runs[run].range;
+            if (!range || range->layout != layout)
+                continue;
+            GLuint runLength = static_cast<GLuint>(runs[run].end - runs[run].begin);
+            indirect[commandCount++] = {range->indexCount, gpuCulling ? 0 : runLength, range->firstIndex, range->baseVertex, instance};
+            for (size_t i = runs[run].begin; i < runs[run].end; i++, instance++)
+            {
+                if (gpuCulling)
+                {
+                    GpuCuller::Object &object = objects[instance];
+                    std::memcpy(object.model, glm::value_ptr(*commands[i].model), sizeof(object.model));
+                    object.sphere[0] = range->bounds.center.x;
+                    object.sphere[1] = range->bounds.center.y;
+                    object.sphere[2] = range->bounds.center.z;
+                    object.sphere[3] = range->bounds.radius;
+                    object.command = static_cast<GLuint>(commandCount-1);
+                    object.material = commands[i].material;
+                }
+                else
+                {
+                    std::memcpy(instances[instance].model, glm::value_ptr(*commands[i].model), sizeof(instances[instance].model));
+                    instances[instance].material = commands[i].material;
+                }
+            }
+        }
+        layoutEnds[layout] = commandCount;
+    }
+
+    if (m_drawPath == DrawPath::Indirect)
+        m_meshPool->UploadCommands(indirect, commandCount);
+    if (gpuCulling)
+    {
+        m_culler->Cull(objects, instanceCount, m_camera->GetFrustum(), m_camera->GetViewProjection(), *m_meshPool);
+        if (m_cullingStats)
+        {
+            // Counted a few frames later, once the GPU is done with them
+            m_culler->QueueVisibleCount(*m_meshPool, commandCount, instanceCount);
+            size_t visible, tested;
+            if (m_culler->ReadVisibleCount(visible, tested))
+            {
+                m_gpuTestedCount = tested;
+                m_gpuCulledCount = tested - visible;
+            }
+            m_testedCount = m_gpuTestedCount;
+            m_culledCount = m_gpuCulledCount;
+        }
+    }
+    else
+    {
+        m_meshPool->UploadInstances(instances, instanceCount);
+    }
+    __UseVariant(true);
+    for (unsigned int layout = 0; layout < m_meshPool->GetLayoutCount(); layout++)
+    {
+        size_t first = layout ? layoutEnds[layout-1] : 0;
+        size_t layoutCommands = layoutEnds[layout] - first;
+        if (!layoutCommands)
+            continue;
+        m_meshPool->Bind(layout);
+        if (m_drawPath == DrawPath::Indirect)
+        {
+            m_meshPool->MultiDraw(first, layoutCommands);
+            m_drawCalls++;
+        }
+        else
+        {
+            m_meshPool->DrawLoop(indirect+first, layoutCommands);
+            m_drawCalls += layoutCommands;
+        }
+    }
+    __UseVariant(false);
+}
+
+// @brief Binds the shader's variant with or without instancing, and sends it the uniforms of the frame it lacks.
+// @note Each variant is a program of its own: the camera is sent again to one only once it changed since its last use.
+void Packet::__UseVariant(bool instanced)
+{
+    if (m_shader->GetVersion() != m_shaderVersion)
+    {
+        // Reloaded programs start without any uniform
+        m_cameraVersions[0] = m_cameraVersions[1] = ~std::uint64_t(0);
+        m_shaderVersion = m_shader->GetVersion();
+    }
+    m_shader->UseVariant(instanced ? m_instancedVariant : 0);
+    if (m_textures)
+        m_shader->SetInt("boardSampler", 0);
+    std::uint64_t &cameraVersion = m_cameraVersions[instanced];
+    if (m_camera->GetVersion() != cameraVersion)
+    {
+        m_shader->SetMatrix4fv("view", glm::value_ptr(m_camera->GetViewMat()));
+        m_shader->SetMatrix4fv("perspective", glm::value_ptr(m_camera->GetPerspectiveMat()));
+        cameraVersion = m_camera->GetVersion();
+    }
+}
+
+void Packet::CheckContact(float timeFrame, double x_mouse, double y_mouse)
+{
+    float z_camera = m_camera->GetTarget().z;
+    glm::vec3 direction = m_camera->GetDirection();
+    m_world->Each<Transform, Collider>([&](Transform &transform, Collider &collider)
+    {
+        // Reachable when the cursor is within the entity's bounding sphere
+        double dx = x_mouse - transform.position.x;
+        double dy = y_mouse - transform.position.y;
+        float r = collider.radius;
+        if (dx*dx + dy*dy < r*r && transform.position.z-r < z_camera && z_camera < transform.position.z+r)
+        {
+            transform.position += direction;
+            transform.rotationAngle += timeFrame;
+            transform.UpdateModel();
+        }
+    });
 }
 
 // @brief Renders every entity that is contained in the environment.
 // @note Updates all uniforms and draws entities.
 void Packet::Render(float timeFrame)
 {
-    // First, use the shader program
-    m_shader->UseProgram();
+    m_drawCalls = 0;
+    // One bind for the whole board
+    if (m_textures)
+        m_textures->Bind(0);
+    // The program keeps its uniforms: the camera is only sent again when it changed
+    __UseVariant(false);
+
+    if (m_arena)
+    {
+        // Everything but the GL calls is done beforehand, across the pool's threads for large boards
+        size_t count = 0;
+        DrawCommand *commands = __RecordCommands(count);
+        m_testedCount = 0;
+        m_culledCount = 0;
+        if (m_softwareOcclusion)
+            count = __CullSoftware(commands, count);
+        commands = __SortCommands(commands, count);
 
-    // Then, update uniforms
-    m_shader->SetInt("woodSampler", 0); // woodSampler in the vertex shader is equal to the wood texture
-    m_shader->SetInt("smileySampler", 1); // smileySampler in the vertex shader is equal to the smiley texture
+        bool pooled = m_meshPool && m_drawPath != DrawPath::Direct;
+        if (pooled && m_hiZ && m_culler && m_drawPath == DrawPath::Indirect)
+            __BuildHiZ(commands, count);
+        if (pooled)
+            __DrawPooled(commands, count);
 
-    m_shader->SetMatrix4fv("view", glm::value_ptr(m_camera->GetViewMat()));
-    m_shader->SetMatrix4fv("perspective", glm::value_ptr(m_camera->GetPerspectiveMat()));
-    for (auto &ent: m_entities)
+        // Replay: only the state that changes between two draws is sent to the driver
+        int modelLocation = m_shader->GetUniformLocation("model");
+        int materialLocation = m_shader->GetUniformLocation("materialLayer");
+        bool skip = false;
+        for (size_t i = 0; i < count; i++)
+        {
+            const DrawCommand &command = commands[i];
+            bool newMesh = !i || command.mesh != commands[i-1].mesh;
+            if (newMesh)
+            {
+                // The pool's meshes are already drawn
+                skip = pooled && m_meshPool->Find(command.mesh);
+                if (!skip)
+                    command.mesh->Bind();
+            }
+            if (skip)
+                continue;
+            if (newMesh || command.material != commands[i-1].material)
+                m_shader->SetInt(materialLocation, command.material);
+            m_shader->SetMatrix4fv(modelLocation, glm::value_ptr(*command.model));
+            if (command.lod)
+                command.mesh->DrawLod(command.lod);
+            else
+                command.mesh->Draw();
+            m_drawCalls++;
+        }
+    }
+    else
     {
-        // Modifies entities positions in space using the model matrix
-        m_shader->SetMatrix4fv("model", glm::value_ptr(ent.GetModelMat()));
-        // Each cube is built with 6 squares containing 2 triangles each.
-        // Each triangle has 3 summits: 6*2*3 = 36 points to draw.
-        ent.Draw(36); 
+        m_world->Each<Transform, Renderable>([this](Transform &transform, Renderable &renderable)
+        {
+            // Modifies entities positions in space using the model matrix
+            m_shader->SetMatrix4fv("model", glm::value_ptr(transform.model));
+            m_shader->SetInt("materialLayer", renderable.material);
+            // Draws the whole buffer: a cube is 6 squares of 2 triangles, 6*2*3 = 36 indices
+            renderable.mesh->Bind();
+            renderable.mesh->Draw();
+            m_drawCalls++;
+        });
     }
 
     // Generates a new lookAt/view matrix based off user interactions: mouse click, motion ...
     m_camera->UpdateView();
-}
\ No newline at end of file
+}
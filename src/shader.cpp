@@ -1,25 +1,28 @@
 #include "shader.hpp"
+#include "shaderCache.hpp"
+#include "hash.hpp"
+#include "glCaps.hpp"
 
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <utility>
+#include <vector>
 
 /* --------------- Private Functions --------------- */
 
+// @brief Reads a whole shader file in one go.
 std::string 
 Shader::Parse(const std::string &fileName)
 {
-    std::ifstream file(m_filePath+fileName);
+    std::ifstream file(m_filePath+fileName, std::ios::binary | std::ios::ate);
     std::string fileContent;
 
     if (file)
     {
-        std::string line;
-        while (std::getline(file, line))
-        {
-            fileContent += line + "\n";
-        }
-        file.close();
+        fileContent.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(&fileContent[0], fileContent.size());
     }
     else
     {
@@ -28,76 +31,352 @@ Shader::Parse(const std::string &fileName)
     return fileContent;
 }
 
-/* --------------- Public Functions --------------- */
-
-unsigned int
-Shader::CreateShaderProgram(const std::string &vertexShaderFileName,
-    const std::string &fragmentShaderFileName)
+// @brief Sends a variant's stages to the driver: every compile and the link are issued, nothing is waited for.
+// Loaded from the shader cache instead when it has these sources, the build is then done at once.
+// @note The variant keeps its current program, if any, until __FinishVariant().
+// @note A cached binary is used only for the same full source of every stage, defines included: any edit of
+// a file compiles it again. Each variant has its own cache entry, which the new binary replaces.
+void
+Shader::__StartVariant(int variant)
 {
-    m_program = glCreateProgram();
-    // m_vertexShader = parse(vertexShaderFileName);
-    // m_fragmentShader = parse(m_fragmentShader);
-    
-    // Compile the vertex shader
-    unsigned int vs = Compile(vertexShaderFileName, GL_VERTEX_SHADER);
-    // Compile the fragment shader
-    unsigned int fs = Compile(fragmentShaderFileName, GL_FRAGMENT_SHADER);
+    auto start = std::chrono::steady_clock::now();
+    Variant &built = m_variants[variant];
+    built.building = glCreateProgram();
+    std::string defines = m_defines + built.defines;
+
+    std::vector<std::string> sources;
+    std::uint64_t hash = 14695981039346656037ull;
+    std::uint64_t key = Hash64(defines.data(), defines.size());
+    for (int i = 0; i < m_stageCount; i++)
+    {
+        key = Hash64(&m_shaderTypes[i], sizeof(GLenum), key);
+        key = Hash64(m_fileNames[i].data(), m_fileNames[i].size(), key);
+        sources.push_back(Parse(m_fileNames[i]));
+        // #version must stay the first statement of the source
+        size_t position = 0;
+        if (!sources[i].compare(0, 8, "#version"))
+        {
+            if (sources[i].find('\n') == std::string::npos)
+                sources[i] += '\n';
+            position = sources[i].find('\n') + 1;
+        }
+        sources[i].insert(position, defines);
+        hash = Hash64(&m_shaderTypes[i], sizeof(GLenum), hash);
+        hash = Hash64(sources[i].data(), sources[i].size(), hash);
+    }
+
+    built.hash = hash;
+    built.key = key;
+    if (!ShaderCache::Load(built.building, key, hash))
+    {
+        for (int i = 0; i < m_stageCount; i++)
+        {
+            built.shaders.push_back(__CompileSource(sources[i], m_shaderTypes[i]));
+            glAttachShader(built.building, built.shaders[i]);
+        }
+        if (ShaderCache::IsEnabled())
+            glProgramParameteri(built.building, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+        // Link the shader program, its status is only read by __FinishVariant()
+        glLinkProgram(built.building);
+    }
+
+    ShaderCache::GetStats().seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
 
-    // Attach all shaders in one program
-    glAttachShader(m_program, vs);
-    glAttachShader(m_program, fs);
+// @brief Reads the compile and link status of a started variant, which waits for the driver if it's not done yet,
+// then makes the new program the variant's one.
+// @return false if nothing replaced the variant's program: it was not being built, or the build failed
+// and the previous version is kept.
+bool
+Shader::__FinishVariant(int variant)
+{
+    Variant &built = m_variants[variant];
+    if (!built.building)
+        return false;
+    auto start = std::chrono::steady_clock::now();
 
-    // Link the shader program
-    glLinkProgram(m_program);
+    bool compiled = true;
+    for (unsigned int shader: built.shaders)
+    {
+        compiled = __CheckShader(shader) && compiled;
+    }
 
     // Shader Link Error Handling
     int success;
-    glGetProgramiv(m_program, GL_LINK_STATUS, &success);
+    glGetProgramiv(built.building, GL_LINK_STATUS, &success);
     if(!success) {
         int length;
-        glGetProgramiv(m_program, GL_INFO_LOG_LENGTH, &length);
+        glGetProgramiv(built.building, GL_INFO_LOG_LENGTH, &length);
         // Alloc dynamically on the stack
         char* message = (char *)alloca(length * sizeof(char));
-        glGetProgramInfoLog(m_program, 512, NULL, message);
+        glGetProgramInfoLog(built.building, length, NULL, message);
         std::cout << message << std::endl;
     }
+    else if (!built.shaders.empty())
+    {
+        // Not when the binary came from the cache
+        ShaderCache::Store(built.building, built.key, built.hash);
+    }
+
+    for (unsigned int shader: built.shaders)
+    {
+        glDetachShader(built.building, shader);
+        glDeleteShader(shader);
+    }
+    built.shaders.clear();
+
+    // A broken edit keeps the version that worked, a first build is kept either way
+    bool replaced = (success && compiled) || !built.program;
+    if (replaced)
+    {
+        if (built.program)
+            glDeleteProgram(built.program);
+        built.program = built.building;
+    }
+    else
+    {
+        std::cout << "Failed to rebuild " << m_fileNames[0] << (m_stageCount > 1 ? " + " + m_fileNames[1] : "")
+                  << ", keeping the previous version" << std::endl;
+        glDeleteProgram(built.building);
+    }
+    built.building = 0;
+
+    ShaderCache::GetStats().seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return replaced;
+}
+
+// @brief Drops a build in flight, the variant keeps its current program.
+void
+Shader::__DiscardBuild(Variant &variant)
+{
+    for (unsigned int shader: variant.shaders)
+    {
+        glDeleteShader(shader);
+    }
+    if (variant.building)
+        glDeleteProgram(variant.building);
+    variant.shaders.clear();
+    variant.building = 0;
+}
+
+/* --------------- Public Functions --------------- */
+
+unsigned int
+Shader::CreateShaderProgram(const std::string &vertexShaderFileName,
+    const std::string &fragmentShaderFileName)
+{
+    StartShaderProgram(vertexShaderFileName, fragmentShaderFileName);
+    __FinishVariant(0);
+    m_program = m_variants[0].program;
 
     // Save the current program
     glValidateProgram(m_program);
 
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-
     // Return the current shader program
     return m_program;
 }
 
+// @brief Builds a program of a single compute shader.
+// @note Needs a GL 4.3 context, see GLCaps::HasComputeShaders().
+unsigned int
+Shader::CreateComputeProgram(const std::string &computeShaderFileName)
+{
+    m_fileNames[0] = computeShaderFileName;
+    m_shaderTypes[0] = GL_COMPUTE_SHADER;
+    m_stageCount = 1;
+    // The other variants are built again from these files on their next use
+    DeleteProgram();
+    m_variant = 0;
+    __StartVariant(0);
+    __FinishVariant(0);
+    m_program = m_variants[0].program;
+    return m_program;
+}
+
+// @brief Same as CreateShaderProgram() without waiting for the driver: the program (variant 0) is compiled
+// while the caller goes on, e.g. loading the assets. Its first UseVariant() waits for what's left.
+void
+Shader::StartShaderProgram(const std::string &vertexShaderFileName, const std::string &fragmentShaderFileName)
+{
+    m_fileNames[0] = vertexShaderFileName;
+    m_fileNames[1] = fragmentShaderFileName;
+    m_shaderTypes[0] = GL_VERTEX_SHADER;
+    m_shaderTypes[1] = GL_FRAGMENT_SHADER;
+    m_stageCount = 2;
+    // The other variants are built again from these files on their next use
+    DeleteProgram();
+    m_variant = 0;
+    __StartVariant(0);
+    m_program = m_variants[0].program;
+}
+
 unsigned int 
 Shader::Compile(const std::string &fileName, GLenum shaderType)
+{
+    unsigned int shader = __CompileSource(Parse(fileName), shaderType);
+    __CheckShader(shader);
+    return shader;
+}
+
+// @note Doesn't wait for the compile, see __CheckShader().
+unsigned int
+Shader::__CompileSource(const std::string &source, GLenum shaderType)
 {
     m_ID = glCreateShader(shaderType);
-    m_sourceCode = Parse(fileName);
-    const char *sourceCode = m_sourceCode.c_str();
+    const char *sourceCode = source.c_str();
     glShaderSource(m_ID, 1, &sourceCode, nullptr);
     glCompileShader(m_ID);
+    return m_ID;
+}
 
+// @brief Prints the log of a failed compile.
+// @note Reading the status waits for the compile to be done.
+bool
+Shader::__CheckShader(unsigned int shader) const
+{
     // Shader Compilation Error Handling
     int result;
-    glGetShaderiv(m_ID, GL_COMPILE_STATUS, &result);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &result);
     if (result == GL_FALSE)
     {
         int length;
-        glGetShaderiv(m_ID, GL_INFO_LOG_LENGTH, &length);
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
         // Allocate data dynamically on the stack with alloca
         char* message = (char *)alloca(length * sizeof(char));
-        glGetShaderInfoLog(m_ID, length, &length, message);
+        glGetShaderInfoLog(shader, length, &length, message);
         std::cout << message << std::endl;
-        // std::cout << "Compilation Error: " << 
-        //     (shaderType == GL_VERTEX_SHADER) ? "GL_VERTEX_SHADER" :
-        //     "GL_FRAGMENT_SHADER." << std::endl;
     }
+    return result != GL_FALSE;
+}
 
-    return m_ID;
+// @brief #define lines shared by every variant, e.g. options picked once at startup.
+// @note Must be set before CreateShaderProgram(), the variants built so far keep their defines.
+void
+Shader::SetDefines(const std::string &defines)
+{
+    m_defines = defines;
+}
+
+// @brief Registers a variant of the program, built from the same files with extra #define lines.
+// @param defines As built by Define(), e.g. Define("INSTANCED").
+// @return The index UseVariant() takes, the same one for the same defines.
+// @note Nothing is compiled until the first UseVariant().
+int
+Shader::AddVariant(const std::string &defines)
+{
+    for (size_t i = 0; i < m_variants.size(); i++)
+    {
+        if (m_variants[i].defines == defines)
+            return static_cast<int>(i);
+    }
+    m_variants.push_back({defines, 0, 0, {}, 0, 0});
+    return static_cast<int>(m_variants.size() - 1);
+}
+
+// @brief Issues the compile of a variant ahead of its first use, e.g. while the assets load.
+// @note Does nothing if the variant is already built or being built.
+void
+Shader::StartVariant(int variant)
+{
+    if (!m_variants[variant].program && !m_variants[variant].building)
+        __StartVariant(variant);
+}
+
+// @brief Whether the variant's build in flight, or its program if none, can be used without waiting for the driver.
+// @note Without KHR_parallel_shader_compile there's no asking: a started build counts as ready,
+// reading its status then waits for it.
+bool
+Shader::IsVariantReady(int variant)
+{
+    Variant &built = m_variants[variant];
+    if (!built.building)
+        return built.program != 0;
+    GLint done = GL_TRUE;
+    if (GLCaps::HasParallelShaderCompile())
+        glGetProgramiv(built.building, GL_COMPLETION_STATUS_KHR, &done);
+    return done != GL_FALSE;
+}
+
+// @brief Makes a variant the current program, compiling it (or loading it from the shader cache) on its first use.
+// @note Each variant is a program of its own: its uniforms are set apart from the others'.
+// @note Only waits for a first build: a reload in flight is swapped in by SwapReloaded().
+void
+Shader::UseVariant(int variant)
+{
+    if (!m_variants[variant].program)
+    {
+        StartVariant(variant);
+        __FinishVariant(variant);
+    }
+    m_program = m_variants[variant].program;
+    m_variant = variant;
+    glUseProgram(m_program);
+}
+
+// @return Whether the program reads the file, one of the stages it was created from.
+bool
+Shader::Uses(const std::string &fileName) const
+{
+    for (int i = 0; i < m_stageCount; i++)
+    {
+        if (m_fileNames[i] == fileName)
+            return true;
+    }
+    return false;
+}
+
+// @brief Builds every variant again from the files as they are now, e.g. after one of them was edited.
+// @note Nothing is waited for: the current programs stay in use until SwapReloaded() finds the new ones ready.
+// The variants never used so far are left alone, they'll be built from the new files anyway.
+void
+Shader::StartReload()
+{
+    for (int i = 0; i < static_cast<int>(m_variants.size()); i++)
+    {
+        Variant &variant = m_variants[i];
+        if (!variant.program && !variant.building)
+            continue;
+        __DiscardBuild(variant);
+        __StartVariant(i);
+    }
+    m_reloading = true;
+}
+
+// @brief Replaces the programs StartReload() rebuilt, all of them at once once they're all done.
+// Call it between two frames: a frame never mixes old and new variants.
+// @return true if a program was replaced, its uniforms must be set again (see GetVersion()).
+// @note A variant that fails to compile or link keeps its previous program.
+bool
+Shader::SwapReloaded()
+{
+    if (!m_reloading)
+        return false;
+    for (int i = 0; i < static_cast<int>(m_variants.size()); i++)
+    {
+        if (m_variants[i].building && !IsVariantReady(i))
+            return false;
+    }
+    bool replaced = false;
+    for (int i = 0; i < static_cast<int>(m_variants.size()); i++)
+    {
+        replaced = __FinishVariant(i) || replaced;
+    }
+    m_reloading = false;
+    if (replaced)
+    {
+        m_program = m_variants[m_variant].program;
+        m_version++;
+        std::cout << "Reloaded " << m_fileNames[0] << (m_stageCount > 1 ? " + " + m_fileNames[1] : "") << std::endl;
+    }
+    return replaced;
+}
+
+// @return One #define line, to concatenate into the defines of a variant.
+std::string
+Shader::Define(const std::string &name, int value)
+{
+    return "#define " + name + " " + std::to_string(value) + "\n";
 }
 
 void
@@ -106,10 +385,18 @@ Shader::UseProgram()
     glUseProgram(m_program);
 }
 
+// @brief Deletes every variant built so far.
 void
 Shader::DeleteProgram()
 {
-    glDeleteProgram(m_program);
+    for (Variant &variant: m_variants)
+    {
+        __DiscardBuild(variant);
+        if (variant.program)
+            glDeleteProgram(variant.program);
+        variant.program = 0;
+    }
+    m_reloading = false;
 }
 
 void
@@ -155,4 +442,20 @@ unsigned int
 Shader::GetShaderProgram() const
 {
     return m_program;
-}
\ No newline at end of file
+}
+
+// @return -1 if the program has no active uniform of that name, the setters ignore it.
+int Shader::GetUniformLocation(const std::string &name) const
+{
+    return glGetUniformLocation(m_program, name.c_str());
+}
+
+void Shader::SetInt(int location, int value) const
+{
+    glUniform1i(location, value);
+}
+
+void Shader::SetMatrix4fv(int location, const float *mat4) const
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, mat4);
+}
@@ -0,0 +1,170 @@
+#include "shaderCache.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "glCaps.hpp"
+#include "hash.hpp"
+#include "mappedFile.hpp"
+
+// A temporary file this old was left by a writer that never renamed it: a crash, not a write in progress
+static constexpr std::chrono::hours STALE_TEMPORARY_AGE {1};
+
+// @brief A temporary file name next to the cache file, unique to its writer: two instances of flipper
+// storing the same program at once each write their own file, and whichever rename comes last wins.
+static std::string
+TemporaryPath(const std::string &path)
+{
+    static std::atomic<unsigned long> count {0};
+    static const unsigned int process = std::random_device()();
+    return path + "." + std::to_string(process) + "." + std::to_string(count++) + ".tmp";
+}
+
+// @brief Stores the programs in directory from now on, if the context can give their binaries back.
+// @note The context must be current, GLCaps loaded.
+void ShaderCache::Enable(const std::string &directory)
+{
+    if (!GLCaps::HasProgramBinary())
+    {
+        std::cout << "No program binaries in this context, the shaders are compiled at every launch" << std::endl;
+        return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        std::cerr << "Failed to create the shader cache: " << directory << std::endl;
+        return;
+    }
+
+    // Binaries are only valid for the driver that built them
+    s_driverHash = 14695981039346656037ull;
+    for (GLenum name: {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+        const char *value = reinterpret_cast<const char *>(glGetString(name));
+        if (value)
+            s_driverHash = Hash64(value, std::strlen(value), s_driverHash);
+    }
+    s_directory = (std::filesystem::path(directory) / "").string();
+    s_enabled = true;
+    __Prune();
+}
+
+std::string ShaderCache::__GetPath(std::uint64_t programKey)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.fprog", static_cast<unsigned long long>(programKey));
+    return s_directory + name;
+}
+
+// @brief Deletes the entries this driver can't use: built by another driver, in an older format, or left
+// behind by an interrupted write. Otherwise they would stay forever, nothing ever reads them again.
+// @note A recent temporary file may be another instance's write in progress: only old ones are deleted.
+void ShaderCache::__Prune()
+{
+    unsigned int pruned = 0;
+    std::error_code error;
+    auto now = std::filesystem::file_time_type::clock::now();
+    for (auto &entry: std::filesystem::directory_iterator(s_directory, error))
+    {
+        std::filesystem::path path = entry.path();
+        if (!entry.is_regular_file(error) || (path.extension() != ".fprog" && path.extension() != ".tmp"))
+            continue;
+        bool stale = false;
+        if (path.extension() == ".tmp")
+        {
+            auto written = entry.last_write_time(error);
+            stale = !error && now - written > STALE_TEMPORARY_AGE;
+        }
+        else
+        {
+            MappedFile file;
+            const Header *header = file.Open(path.string()) ? reinterpret_cast<const Header *>(file.GetData()) : nullptr;
+            stale = !header || file.GetSize() < sizeof(Header) || header->magic != MAGIC || header->version != VERSION
+                 || header->driverHash != s_driverHash;
+        }
+        // Closed first: a mapped file can't be deleted on Windows
+        if (stale && std::filesystem::remove(path, error))
+            pruned++;
+    }
+    if (pruned)
+        std::cout << "Shader cache: deleted " << pruned << " stale binaries" << std::endl;
+}
+
+// @brief Links program from its cached binary.
+// @return false if there is no valid binary for these sources and this driver: the program must be compiled.
+bool ShaderCache::Load(GLuint program, std::uint64_t programKey, std::uint64_t sourceHash)
+{
+    if (!s_enabled)
+        return false;
+    MappedFile file;
+    if (!file.Open(__GetPath(programKey)))
+        return false;
+
+    const Header *header = reinterpret_cast<const Header *>(file.GetData());
+    bool valid = file.GetSize() >= sizeof(Header) && header->magic == MAGIC && header->version == VERSION
+              && header->programKey == programKey && header->sourceHash == sourceHash && header->driverHash == s_driverHash
+              && sizeof(Header) + header->binarySize <= file.GetSize();
+    if (!valid)
+        return false;
+
+    glProgramBinary(program, header->binaryFormat, file.GetData() + sizeof(Header), static_cast<GLsizei>(header->binarySize));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        std::cout << "Cached shader binary rejected by the driver, recompiling it" << std::endl;
+        return false;
+    }
+    s_stats.loaded++;
+    return true;
+}
+
+// @brief Writes the binary of a freshly linked program, over the previous one of the same program if any:
+// the binary of sources since edited is replaced, not kept next to the new one.
+// @note The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+void ShaderCache::Store(GLuint program, std::uint64_t programKey, std::uint64_t sourceHash)
+{
+    s_stats.compiled++;
+    if (!s_enabled)
+        return;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+    Header header = {MAGIC, VERSION, programKey, sourceHash, s_driverHash, format, static_cast<std::uint32_t>(length)};
+
+    // Written aside then renamed: a crash never leaves a truncated binary behind
+    std::string path = __GetPath(programKey);
+    std::string temporary = TemporaryPath(path);
+    std::error_code error;
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(binary.data(), binary.size());
+        if (!file)
+        {
+            std::cerr << "Failed to write the shader cache: " << temporary << std::endl;
+            file.close();
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+    {
+        std::cerr << "Failed to write the shader cache: " << path << std::endl;
+        std::filesystem::remove(temporary, error);
+    }
+}
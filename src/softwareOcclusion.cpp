@@ -0,0 +1,204 @@
+#include "softwareOcclusion.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Depth of the pixels an occluder doesn't cover
+static constexpr float UNCOVERED = std::numeric_limits<float>::infinity();
+
+// The 12 triangles of a box, from its corners numbered by their (x, y, z) bits
+static const int BOX_TRIANGLES[12][3] = {
+    {0, 2, 1}, {1, 2, 3}, {4, 5, 6}, {5, 7, 6},
+    {0, 1, 4}, {1, 5, 4}, {2, 6, 3}, {3, 6, 7},
+    {0, 4, 2}, {2, 4, 6}, {1, 3, 5}, {3, 7, 5}
+};
+
+// @param width, height Of the depth buffer: a few hundred pixels wide are enough for large occluders.
+SoftwareOcclusion::SoftwareOcclusion(int width, int height) :
+    m_width {width},
+    m_height {height}
+{
+    size_t size = 0;
+    for (glm::ivec2 level = glm::ivec2(width, height);; level = glm::ivec2(std::max(level.x/2, 1), std::max(level.y/2, 1)))
+    {
+        m_levelOffsets.push_back(size);
+        m_levelSizes.push_back(level);
+        size += static_cast<size_t>(level.x)*level.y;
+        if (level.x == 1 && level.y == 1)
+            break;
+    }
+    m_depth.resize(size);
+    m_coverage.resize(static_cast<size_t>(width)*height, UNCOVERED);
+}
+
+// @brief Clears the depth buffer for a new frame seen through this matrix.
+void SoftwareOcclusion::Begin(const glm::mat4 &viewProjection)
+{
+    m_viewProjection = viewProjection;
+    std::fill(m_depth.begin(), m_depth.begin() + static_cast<size_t>(m_width)*m_height, 1.0f);
+}
+
+// @brief Rasterizes the box of an occluder.
+// @note Its triangles are first sampled at the pixel centers. The box projects to a convex shape, whose nearest
+// depth is convex too: a pixel whose 3x3 neighbouring centers are covered is covered all over, by depths no
+// farther than the farthest of those 9. Only these pixels are written, with that depth; the partly covered
+// pixels of the silhouette are left out.
+// @note Occluders crossing the near plane are skipped: losing an occluder only culls less.
+void SoftwareOcclusion::AddOccluder(const glm::mat4 &model, const BoundingBox &box)
+{
+    glm::mat4 matrix = m_viewProjection*model;
+    glm::vec3 corners[8];
+    glm::vec3 low = glm::vec3(1e30f);
+    glm::vec3 high = glm::vec3(-1e30f);
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec4 clip = matrix*glm::vec4(i & 1 ? box.max.x : box.min.x, i & 2 ? box.max.y : box.min.y,
+                                          i & 4 ? box.max.z : box.min.z, 1.0f);
+        if (clip.w <= 1e-5f)
+            return;
+        // Window coordinates, depth in [0, 1]
+        corners[i] = glm::vec3((clip.x/clip.w*0.5f + 0.5f)*m_width, (clip.y/clip.w*0.5f + 0.5f)*m_height,
+                               clip.z/clip.w*0.5f + 0.5f);
+        low = glm::min(low, corners[i]);
+        high = glm::max(high, corners[i]);
+    }
+    int xMin = std::max(static_cast<int>(std::floor(low.x)), 0);
+    int xMax = std::min(static_cast<int>(std::ceil(high.x)), m_width-1);
+    int yMin = std::max(static_cast<int>(std::floor(low.y)), 0);
+    int yMax = std::min(static_cast<int>(std::ceil(high.y)), m_height-1);
+    if (xMin > xMax || yMin > yMax)
+        return;
+
+    for (int y = yMin; y <= yMax; y++)
+    {
+        std::fill_n(&m_coverage[static_cast<size_t>(y)*m_width + xMin], xMax - xMin + 1, UNCOVERED);
+    }
+    for (auto &triangle: BOX_TRIANGLES)
+    {
+        __RasterizeTriangle(corners[triangle[0]], corners[triangle[1]], corners[triangle[2]]);
+    }
+
+    // The screen's edge pixels have no neighbours past it: they are never written
+    for (int y = std::max(yMin, 1); y <= std::min(yMax, m_height-2); y++)
+    {
+        float *row = &m_depth[static_cast<size_t>(y)*m_width];
+        for (int x = std::max(xMin, 1); x <= std::min(xMax, m_width-2); x++)
+        {
+            float farthest = 0.0f;
+            for (int ny = y-1; ny <= y+1; ny++)
+            {
+                const float *neighbours = &m_coverage[static_cast<size_t>(ny)*m_width + x-1];
+                farthest = std::max({farthest, neighbours[0], neighbours[1], neighbours[2]});
+            }
+            if (farthest != UNCOVERED)
+                row[x] = std::min(row[x], farthest);
+        }
+    }
+}
+
+// @brief Keeps the nearest depth of the occluder at the pixel centers in the triangle, either winding.
+void SoftwareOcclusion::__RasterizeTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c)
+{
+    float area = (b.x - a.x)*(c.y - a.y) - (b.y - a.y)*(c.x - a.x);
+    if (std::abs(area) < 1e-8f)
+        return;
+    float sign = area > 0.0f ? 1.0f : -1.0f;
+
+    int xMin = std::max(static_cast<int>(std::floor(std::min({a.x, b.x, c.x}))), 0);
+    int xMax = std::min(static_cast<int>(std::ceil(std::max({a.x, b.x, c.x}))), m_width-1);
+    int yMin = std::max(static_cast<int>(std::floor(std::min({a.y, b.y, c.y}))), 0);
+    int yMax = std::min(static_cast<int>(std::ceil(std::max({a.y, b.y, c.y}))), m_height-1);
+    for (int y = yMin; y <= yMax; y++)
+    {
+        float py = y + 0.5f;
+        float *row = &m_coverage[static_cast<size_t>(y)*m_width];
+        for (int x = xMin; x <= xMax; x++)
+        {
+            float px = x + 0.5f;
+            float w0 = sign*((c.x - b.x)*(py - b.y) - (c.y - b.y)*(px - b.x));
+            float w1 = sign*((a.x - c.x)*(py - c.y) - (a.y - c.y)*(px - c.x));
+            float w2 = sign*((b.x - a.x)*(py - a.y) - (b.y - a.y)*(px - a.x));
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                continue;
+            // Window depth is affine in screen space
+            float depth = (w0*a.z + w1*b.z + w2*c.z) / (sign*area);
+            row[x] = std::min(row[x], depth);
+        }
+    }
+}
+
+// @brief Builds the pyramid: each texel keeps the farthest depth of the texels it covers in the level below.
+void SoftwareOcclusion::Finish()
+{
+    for (size_t level = 1; level < m_levelSizes.size(); level++)
+    {
+        glm::ivec2 source = m_levelSizes[level-1];
+        glm::ivec2 size = m_levelSizes[level];
+        const float *below = &m_depth[m_levelOffsets[level-1]];
+        float *texels = &m_depth[m_levelOffsets[level]];
+        for (int y = 0; y < size.y; y++)
+        {
+            for (int x = 0; x < size.x; x++)
+            {
+                // Odd sizes: the last texel also covers the leftover row or column
+                int x1 = x == size.x-1 ? source.x-1 : 2*x+1;
+                int y1 = y == size.y-1 ? source.y-1 : 2*y+1;
+                float farthest = 0.0f;
+                for (int sy = std::min(2*y, source.y-1); sy <= y1; sy++)
+                {
+                    for (int sx = std::min(2*x, source.x-1); sx <= x1; sx++)
+                    {
+                        farthest = std::max(farthest, below[static_cast<size_t>(sy)*source.x + sx]);
+                    }
+                }
+                texels[static_cast<size_t>(y)*size.x + x] = farthest;
+            }
+        }
+    }
+}
+
+// @brief Whether the sphere is behind the occluders everywhere on its screen rectangle.
+// @note Spheres crossing the near plane or the screen's edges are tested conservatively.
+bool SoftwareOcclusion::IsOccluded(const glm::vec3 &center, float radius) const
+{
+    glm::vec3 low = glm::vec3(1e30f);
+    glm::vec3 high = glm::vec3(-1e30f);
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec4 clip = m_viewProjection*glm::vec4(center.x + (i & 1 ? radius : -radius), center.y + (i & 2 ? radius : -radius),
+                                                    center.z + (i & 4 ? radius : -radius), 1.0f);
+        if (clip.w <= 1e-5f)
+            return false;
+        glm::vec3 window = glm::vec3((clip.x/clip.w*0.5f + 0.5f)*m_width, (clip.y/clip.w*0.5f + 0.5f)*m_height,
+                                     clip.z/clip.w*0.5f + 0.5f);
+        low = glm::min(low, window);
+        high = glm::max(high, window);
+    }
+    if (high.x < 0.0f || high.y < 0.0f || low.x >= m_width || low.y >= m_height)
+        return false; // Off screen: left to frustum culling
+
+    int xMin = std::max(static_cast<int>(low.x), 0);
+    int yMin = std::max(static_cast<int>(low.y), 0);
+    int xMax = std::min(static_cast<int>(high.x), m_width-1);
+    int yMax = std::min(static_cast<int>(high.y), m_height-1);
+    // The level where the rectangle spans 2x2 texels at most, 3x3 once aligned
+    int extent = std::max(xMax - xMin, yMax - yMin) + 1;
+    size_t level = 0;
+    while ((1 << level) < extent && level+1 < m_levelSizes.size())
+    {
+        level++;
+    }
+
+    glm::ivec2 size = m_levelSizes[level];
+    const float *texels = &m_depth[m_levelOffsets[level]];
+    for (int y = std::min(yMin >> level, size.y-1); y <= std::min(yMax >> level, size.y-1); y++)
+    {
+        for (int x = std::min(xMin >> level, size.x-1); x <= std::min(xMax >> level, size.x-1); x++)
+        {
+            if (low.z <= texels[static_cast<size_t>(y)*size.x + x])
+                return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,167 @@
+#include "table.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include "mappedFile.hpp"
+
+static bool
+IsBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// @brief The next word of the line, empty at the end of the line or at a comment.
+static std::string_view
+NextToken(const char *&cursor, const char *end)
+{
+    while (cursor < end && IsBlank(*cursor))
+        cursor++;
+    const char *start = cursor;
+    while (cursor < end && !IsBlank(*cursor) && *cursor != '\n' && *cursor != '#')
+        cursor++;
+    return std::string_view(start, static_cast<size_t>(cursor-start));
+}
+
+// @brief Reads the next words of the line as numbers, without copying them.
+template <typename T>
+static bool
+NextNumbers(const char *&cursor, const char *end, T *values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        std::string_view token = NextToken(cursor, end);
+        const char *tokenEnd = token.data() + token.size();
+        auto result = std::from_chars(token.data(), tokenEnd, values[i]);
+        if (token.empty() || result.ec != std::errc() || result.ptr != tokenEnd)
+            return false;
+    }
+    return true;
+}
+
+// @brief Index of the mesh or material of that name, -1 if it was not declared.
+template <typename T>
+static long
+Find(const std::vector<T> &items, std::string_view name)
+{
+    // Only a few names: a linear search beats hashing
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        if (items[i].name == name)
+            return static_cast<long>(i);
+    }
+    return -1;
+}
+
+// @brief Maps the table file and parses it.
+bool Table::Load(const std::string &path)
+{
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        std::cerr << "Failed to open the table: " << path << std::endl;
+        return false;
+    }
+    m_folder = std::filesystem::path(path).parent_path().string();
+    return Parse(reinterpret_cast<const char *>(file.GetData()), file.GetSize());
+}
+
+// @brief Parses a whole table description in a single pass, see the format in table.hpp.
+// @return false on the first invalid line, reported with its number.
+bool Table::Parse(const char *data, size_t size)
+{
+    m_meshes.clear();
+    m_materials.clear();
+    m_placements.clear();
+
+    const char *cursor = data;
+    const char *end = data + size;
+    unsigned int line = 1;
+    while (cursor < end)
+    {
+        std::string_view keyword = NextToken(cursor, end);
+        bool valid = keyword.empty() || __ParseLine(keyword, cursor, end);
+        // Nothing but a comment may follow a declaration
+        valid = valid && NextToken(cursor, end).empty();
+        if (!valid)
+        {
+            std::cerr << "Invalid table declaration at line " << line << std::endl;
+            return false;
+        }
+
+        const char *newline = static_cast<const char *>(std::memchr(cursor, '\n', static_cast<size_t>(end-cursor)));
+        cursor = newline ? newline+1 : end;
+        line++;
+    }
+    return true;
+}
+
+// @brief Reads one declaration, the cursor is right after its keyword.
+bool Table::__ParseLine(std::string_view keyword, const char *&cursor, const char *end)
+{
+    if (keyword == "entities")
+    {
+        // Negative or out of range counts don't parse, the others are capped before reserving anything
+        size_t count;
+        if (!NextNumbers(cursor, end, &count, 1))
+            return false;
+        if (count > MAX_ENTITIES)
+        {
+            std::cerr << "Too many entities: " << count << ", at most " << MAX_ENTITIES << std::endl;
+            return false;
+        }
+        m_placements.reserve(count);
+    }
+    else if (keyword == "mesh" || keyword == "material")
+    {
+        std::string_view name = NextToken(cursor, end);
+        std::string_view source = NextToken(cursor, end);
+        if (name.empty() || source.empty())
+            return false;
+        if (keyword == "mesh")
+        {
+            // Anything else than the flag is left for Parse() to reject
+            const char *flag = cursor;
+            bool occluder = NextToken(flag, end) == "occluder";
+            if (occluder)
+                cursor = flag;
+            m_meshes.push_back({std::string(name), std::string(source), occluder});
+        }
+        else
+            m_materials.push_back({std::string(name), std::string(source)});
+    }
+    else if (keyword == "entity")
+    {
+        std::string_view meshName = NextToken(cursor, end);
+        std::string_view materialName = NextToken(cursor, end);
+        long mesh = Find(m_meshes, meshName);
+        long material = Find(m_materials, materialName);
+        if (mesh < 0 || material < 0)
+        {
+            std::cerr << "Undeclared " << (mesh < 0 ? "mesh: " : "material: ")
+                      << (mesh < 0 ? meshName : materialName) << std::endl;
+            return false;
+        }
+
+        Placement placement;
+        placement.mesh = static_cast<std::uint32_t>(mesh);
+        placement.material = static_cast<std::uint32_t>(material);
+        if (!NextNumbers(cursor, end, placement.position, 3)
+            || !NextNumbers(cursor, end, placement.rotationAxis, 3)
+            || !NextNumbers(cursor, end, &placement.rotationAngle, 1)
+            || !NextNumbers(cursor, end, placement.scale, 3)
+            || !NextNumbers(cursor, end, &placement.mass, 1)
+            || !NextNumbers(cursor, end, &placement.restitution, 1)
+            || !NextNumbers(cursor, end, &placement.friction, 1))
+            return false;
+        m_placements.push_back(placement);
+    }
+    else
+    {
+        std::cerr << "Unknown table keyword: " << keyword << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,115 @@
+#include "textureArray.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// @param loader Decodes and uploads the layers, must outlive the texture array.
+TextureArray::TextureArray(TextureLoader *loader, int width, int height, int wrappingParam) :
+    m_texture {Texture::Create()},
+    m_width {width},
+    m_height {height},
+    m_wrappingParam {wrappingParam},
+    m_loader {loader}
+{
+}
+
+// @brief Queues the loading of an image into a new layer.
+// @return The layer index to store in the vertices, or -1 once the array is allocated (see Allocate()).
+// @note An image already added returns its layer: it is decoded and stored only once.
+int TextureArray::AddLayer(const std::string &img)
+{
+    for (size_t i = 0; i < m_layers.size(); i++)
+    {
+        if (m_layers[i].img == img)
+            return static_cast<int>(i);
+    }
+    if (m_allocatedLayers)
+    {
+        std::cout << "Failed to add " << img << ": the texture array is already allocated.\n";
+        return -1;
+    }
+    int layer = static_cast<int>(m_layers.size());
+    m_layers.push_back({img, m_loader->LoadLayer(m_texture.Get(), layer, m_width, m_height, img)});
+    return layer;
+}
+
+// @brief Loads an image again after it changed on disk, the loader uploads it over its layer.
+// @return false if the image is not a layer of the array.
+// @note Until then the layer keeps showing the previous image, and keeps it if the new one fails to decode.
+bool TextureArray::ReloadLayer(const std::string &img)
+{
+    for (size_t i = 0; i < m_layers.size(); i++)
+    {
+        if (m_layers[i].img != img)
+            continue;
+        m_layers[i].uploaded = m_loader->LoadLayer(m_texture.Get(), static_cast<int>(i), m_width, m_height, img);
+        return true;
+    }
+    return false;
+}
+
+// @brief Allocates one layer per image added so far, with its whole mip chain, each filled with the placeholder.
+// @note Call once from the GL thread after the last AddLayer(), before the loader's first Update():
+// the loader uploads every level of each layer into this storage, mipmaps are never generated afterwards.
+void TextureArray::Allocate()
+{
+    if (m_allocatedLayers || m_layers.empty())
+        return;
+    m_allocatedLayers = static_cast<unsigned int>(m_layers.size());
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture.Get());
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, m_wrappingParam);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, m_wrappingParam);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    std::vector<unsigned char> placeholder(static_cast<size_t>(m_width)*m_height*m_allocatedLayers*4);
+    for (size_t i = 0; i < placeholder.size(); i++)
+    {
+        placeholder[i] = PLACEHOLDER[i%4];
+    }
+    // Every level down to 1x1, the same chain as the texture cache's
+    int width = m_width;
+    int height = m_height;
+    for (int level = 0; ; level++)
+    {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, width, height, m_allocatedLayers, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     placeholder.data());
+        if (width == 1 && height == 1)
+            break;
+        width = std::max(1, width/2);
+        height = std::max(1, height/2);
+    }
+}
+
+// @brief True once every layer is uploaded or failed to load.
+bool TextureArray::IsComplete() const
+{
+    for (auto &layer: m_layers)
+    {
+        if (layer.uploaded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+    }
+    return true;
+}
+
+// @brief Binds the whole array to one texture unit: the only bind the board needs.
+void TextureArray::Bind(unsigned int unit)
+{
+    glActiveTexture(GL_TEXTURE0+unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture.Get());
+}
+
+// @brief Copies interleaved vertices and appends the layer index as a new float attribute.
+// @param stride In floats, the size of one input vertex. Output vertices are stride+1 floats.
+std::vector<float> TextureArray::AppendLayer(const float *vertices, size_t vertexCount, unsigned int stride, float layer)
+{
+    std::vector<float> result;
+    result.reserve(vertexCount*(stride+1));
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        result.insert(result.end(), vertices + i*stride, vertices + (i+1)*stride);
+        result.push_back(layer);
+    }
+    return result;
+}
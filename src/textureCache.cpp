@@ -0,0 +1,335 @@
+#include "textureCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "hash.hpp"
+#include "stb_image.h"
+
+// Pixel data of each level starts on this boundary
+static constexpr std::uint64_t LEVEL_ALIGNMENT = 16;
+
+// @brief Halves an RGBA8 image with a 2x2 box filter, odd edges are clamped.
+static std::vector<unsigned char>
+Downsample(const std::vector<unsigned char> &src, int width, int height, int &newWidth, int &newHeight)
+{
+    newWidth = std::max(1, width/2);
+    newHeight = std::max(1, height/2);
+    std::vector<unsigned char> dst(static_cast<size_t>(newWidth)*newHeight*4);
+    for (int y = 0; y < newHeight; y++)
+    {
+        int y0 = std::min(2*y, height-1);
+        int y1 = std::min(2*y+1, height-1);
+        for (int x = 0; x < newWidth; x++)
+        {
+            int x0 = std::min(2*x, width-1);
+            int x1 = std::min(2*x+1, width-1);
+            for (int c = 0; c < 4; c++)
+            {
+                int sum = src[(static_cast<size_t>(y0)*width+x0)*4+c] + src[(static_cast<size_t>(y0)*width+x1)*4+c]
+                        + src[(static_cast<size_t>(y1)*width+x0)*4+c] + src[(static_cast<size_t>(y1)*width+x1)*4+c];
+                dst[(static_cast<size_t>(y)*newWidth+x)*4+c] = static_cast<unsigned char>((sum+2)/4);
+            }
+        }
+    }
+    return dst;
+}
+
+static std::uint16_t
+To565(const unsigned char *rgb)
+{
+    return static_cast<std::uint16_t>(((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3));
+}
+
+static void
+From565(std::uint16_t color, int *rgb)
+{
+    rgb[0] = ((color >> 11) & 31)*255/31;
+    rgb[1] = ((color >> 5) & 63)*255/63;
+    rgb[2] = (color & 31)*255/31;
+}
+
+// @brief Encodes an RGBA8 image to BC1 (DXT1, 4 bits per pixel, no alpha).
+// @note Endpoints are the corners of the block's color bounding box: fast, good enough for the board's textures.
+static std::vector<unsigned char>
+EncodeBC1(const std::vector<unsigned char> &rgba, int width, int height)
+{
+    int blocksX = (width+3)/4;
+    int blocksY = (height+3)/4;
+    std::vector<unsigned char> blocks(static_cast<size_t>(blocksX)*blocksY*8);
+    unsigned char *out = blocks.data();
+
+    for (int by = 0; by < blocksY; by++)
+    {
+        for (int bx = 0; bx < blocksX; bx++)
+        {
+            unsigned char texels[16][3];
+            unsigned char low[3] = {255, 255, 255};
+            unsigned char high[3] = {0, 0, 0};
+            for (int i = 0; i < 16; i++)
+            {
+                // Blocks overlapping the edge repeat the last row/column
+                int x = std::min(bx*4 + i%4, width-1);
+                int y = std::min(by*4 + i/4, height-1);
+                for (int c = 0; c < 3; c++)
+                {
+                    texels[i][c] = rgba[(static_cast<size_t>(y)*width+x)*4+c];
+                    low[c] = std::min(low[c], texels[i][c]);
+                    high[c] = std::max(high[c], texels[i][c]);
+                }
+            }
+
+            std::uint16_t color0 = To565(high);
+            std::uint16_t color1 = To565(low);
+            std::uint32_t indices = 0;
+            // color0 > color1 selects the 4 colors mode, equal endpoints keep every index at 0
+            if (color0 < color1)
+                std::swap(color0, color1);
+            if (color0 != color1)
+            {
+                int palette[4][3];
+                From565(color0, palette[0]);
+                From565(color1, palette[1]);
+                for (int c = 0; c < 3; c++)
+                {
+                    palette[2][c] = (2*palette[0][c] + palette[1][c])/3;
+                    palette[3][c] = (palette[0][c] + 2*palette[1][c])/3;
+                }
+                for (int i = 0; i < 16; i++)
+                {
+                    int best = 0;
+                    int bestDistance = 1 << 30;
+                    for (int p = 0; p < 4; p++)
+                    {
+                        int distance = 0;
+                        for (int c = 0; c < 3; c++)
+                        {
+                            int d = texels[i][c] - palette[p][c];
+                            distance += d*d;
+                        }
+                        if (distance < bestDistance)
+                        {
+                            bestDistance = distance;
+                            best = p;
+                        }
+                    }
+                    indices |= static_cast<std::uint32_t>(best) << (2*i);
+                }
+            }
+
+            // Little endian layout: color0, color1, then 2 bits per texel
+            out[0] = color0 & 0xFF;
+            out[1] = color0 >> 8;
+            out[2] = color1 & 0xFF;
+            out[3] = color1 >> 8;
+            for (int i = 0; i < 4; i++)
+            {
+                out[4+i] = (indices >> (8*i)) & 0xFF;
+            }
+            out += 8;
+        }
+    }
+    return blocks;
+}
+
+// @return Whether [offset, offset+bytes) lies in a file of the given size, without overflowing.
+static bool
+Fits(std::uint64_t offset, std::uint64_t bytes, std::uint64_t size)
+{
+    return offset <= size && bytes <= size - offset;
+}
+
+// @return The size in bytes of a level of the given format and dimensions, as BuildLevels() writes it.
+static std::uint64_t
+LevelSize(std::uint32_t format, std::uint32_t width, std::uint32_t height)
+{
+    if (format == TextureCache::FORMAT_BC1)
+        return ((static_cast<std::uint64_t>(width)+3)/4)*((static_cast<std::uint64_t>(height)+3)/4)*8;
+    return static_cast<std::uint64_t>(width)*height*4;
+}
+
+// @brief A temporary file name next to the cache file, unique to its writer: two threads or processes writing
+// the cache of the same image at once each write their own file, and whichever rename comes last wins.
+static std::string
+TemporaryPath(const std::string &cachePath)
+{
+    static std::atomic<unsigned long> count {0};
+    // Tells the processes apart, e.g. texture_cache running along with flipper
+    static const unsigned int process = std::random_device()();
+    return cachePath + "." + std::to_string(process) + "." + std::to_string(count++) + ".tmp";
+}
+
+// @brief Hashes the content of the source image, the key that validates its cache file.
+bool TextureCache::HashSource(const std::string &sourcePath, std::uint64_t &hash)
+{
+    MappedFile source;
+    if (!source.Open(sourcePath))
+        return false;
+    hash = Hash64(source.GetData(), source.GetSize());
+    return true;
+}
+
+// @brief Builds the full mip chain of an image, down to 1x1.
+// @param pixels Decoded image, channels bytes per pixel (1 to 4).
+// @param format FORMAT_RGBA8 or FORMAT_BC1.
+// @param levels, levelData Receive the size and the pixels of every level, offsets are left at 0.
+void TextureCache::BuildLevels(const unsigned char *pixels, int width, int height, int channels, std::uint32_t format,
+                               std::vector<Level> &levels, std::vector<std::vector<unsigned char>> &levelData)
+{
+    // Expands the source to RGBA8
+    std::vector<unsigned char> rgba(static_cast<size_t>(width)*height*4);
+    for (size_t i = 0; i < static_cast<size_t>(width)*height; i++)
+    {
+        const unsigned char *texel = pixels + i*channels;
+        rgba[4*i] = texel[0];
+        rgba[4*i+1] = channels > 2 ? texel[1] : texel[0];
+        rgba[4*i+2] = channels > 2 ? texel[2] : texel[0];
+        rgba[4*i+3] = channels == 4 ? texel[3] : (channels == 2 ? texel[1] : 255);
+    }
+
+    levels.clear();
+    levelData.clear();
+    int levelWidth = width;
+    int levelHeight = height;
+    while (true)
+    {
+        levelData.emplace_back(format == FORMAT_BC1 ? EncodeBC1(rgba, levelWidth, levelHeight) : rgba);
+        levels.push_back({static_cast<std::uint32_t>(levelWidth), static_cast<std::uint32_t>(levelHeight), 0, levelData.back().size()});
+        if (levelWidth == 1 && levelHeight == 1)
+            break;
+        rgba = Downsample(rgba, levelWidth, levelHeight, levelWidth, levelHeight);
+    }
+}
+
+// @brief Builds the full mip chain of an image and writes it as a cache file.
+// @param pixels Decoded image, channels bytes per pixel (1 to 4).
+// @param format FORMAT_RGBA8 or FORMAT_BC1.
+bool TextureCache::Write(const std::string &cachePath, std::uint64_t sourceHash, const unsigned char *pixels,
+                         int width, int height, int channels, std::uint32_t format)
+{
+    std::vector<Level> levels;
+    std::vector<std::vector<unsigned char>> levelData;
+    BuildLevels(pixels, width, height, channels, format, levels, levelData);
+    return WriteLevels(cachePath, sourceHash, format, levels, levelData);
+}
+
+// @brief Writes a mip chain built by BuildLevels() as a cache file.
+// @note Written to a temporary file first: a reader never maps a half-written cache.
+bool TextureCache::WriteLevels(const std::string &cachePath, std::uint64_t sourceHash, std::uint32_t format,
+                               std::vector<Level> levels, const std::vector<std::vector<unsigned char>> &levelData)
+{
+    Header header {MAGIC, VERSION, sourceHash, format, levels.front().width, levels.front().height,
+                   static_cast<std::uint32_t>(levels.size())};
+    std::uint64_t offset = sizeof(Header) + levels.size()*sizeof(Level);
+    for (auto &level: levels)
+    {
+        offset = (offset + LEVEL_ALIGNMENT-1) & ~(LEVEL_ALIGNMENT-1);
+        level.offset = offset;
+        offset += level.size;
+    }
+
+    std::string temporaryPath = TemporaryPath(cachePath);
+    std::error_code error;
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cerr << "Failed to write the texture cache: " << cachePath << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char *>(levels.data()), levels.size()*sizeof(Level));
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            // Padding up to the level's offset
+            static const char zeros[LEVEL_ALIGNMENT] = {};
+            file.write(zeros, levels[i].offset - static_cast<std::uint64_t>(file.tellp()));
+            file.write(reinterpret_cast<const char *>(levelData[i].data()), levelData[i].size());
+        }
+        if (!file)
+        {
+            file.close();
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporaryPath, cachePath, error);
+    if (!error)
+        return true;
+    std::filesystem::remove(temporaryPath, error);
+    return false;
+}
+
+// @brief Decodes an image and writes its cache file (what the offline tool does for every image).
+bool TextureCache::Build(const std::string &sourcePath, const std::string &cachePath, std::uint32_t format)
+{
+    MappedFile source;
+    if (!source.Open(sourcePath))
+    {
+        std::cerr << "Failed to open the image: " << sourcePath << std::endl;
+        return false;
+    }
+    int width, height, channels;
+    unsigned char *pixels = stbi_load_from_memory(source.GetData(), static_cast<int>(source.GetSize()),
+                                                  &width, &height, &channels, 0);
+    if (!pixels)
+    {
+        std::cerr << "Failed to decode the image: " << sourcePath << std::endl;
+        return false;
+    }
+    bool written = Write(cachePath, Hash64(source.GetData(), source.GetSize()), pixels, width, height, channels, format);
+    stbi_image_free(pixels);
+    return written;
+}
+
+// @brief Maps a cache file and checks it was built from the current source image, then checks it before anything
+// uploads it: a full or partial mip chain of the header's size, each level exactly as large as its format and
+// dimensions make it, and lying inside the file.
+// @return false if the file is missing, truncated, corrupted, from another version or stale.
+bool TextureCache::Open(const std::string &cachePath, std::uint64_t sourceHash)
+{
+    m_header = nullptr;
+    m_levels = nullptr;
+    if (!m_file.Open(cachePath))
+        return false;
+    if (m_file.GetSize() < sizeof(Header))
+    {
+        m_file.Close();
+        return false;
+    }
+
+    const Header *header = reinterpret_cast<const Header *>(m_file.GetData());
+    std::uint64_t size = m_file.GetSize();
+    // A chain halves down to 1x1: at most 32 levels below a 2^32 wide image
+    bool valid = header->magic == MAGIC && header->version == VERSION && header->sourceHash == sourceHash
+              && (header->format == FORMAT_RGBA8 || header->format == FORMAT_BC1)
+              && header->width && header->height && header->levels && header->levels <= 32
+              && Fits(sizeof(Header), static_cast<std::uint64_t>(header->levels)*sizeof(Level), size);
+
+    const Level *levels = reinterpret_cast<const Level *>(m_file.GetData() + sizeof(Header));
+    std::uint32_t width = header->width;
+    std::uint32_t height = header->height;
+    for (std::uint32_t i = 0; valid && i < header->levels; i++)
+    {
+        valid = levels[i].width == width && levels[i].height == height
+             && levels[i].size == LevelSize(header->format, width, height) && Fits(levels[i].offset, levels[i].size, size);
+        // Nothing comes after the 1x1 level
+        valid = valid && (i+1 == header->levels || width > 1 || height > 1);
+        width = std::max(1u, width/2);
+        height = std::max(1u, height/2);
+    }
+    if (!valid)
+    {
+        m_file.Close();
+        return false;
+    }
+    m_header = header;
+    m_levels = levels;
+    return true;
+}
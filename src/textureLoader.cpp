@@ -0,0 +1,349 @@
+#include "textureLoader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+
+#include "glCaps.hpp"
+#include "mappedFile.hpp"
+#include "hash.hpp"
+#include "stb_image.h"
+
+static GLenum
+PixelFormat(int channels)
+{
+    switch (channels)
+    {
+    case 1:
+        return GL_RED;
+    case 2:
+        return GL_RG;
+    case 3:
+        return GL_RGB;
+    default:
+        return GL_RGBA;
+    }
+}
+
+// @brief Bilinear resize of an RGBA8 image.
+static std::vector<unsigned char>
+Resize(const unsigned char *src, int srcWidth, int srcHeight, int width, int height)
+{
+    std::vector<unsigned char> dst(static_cast<size_t>(width)*height*4);
+    float scaleX = static_cast<float>(srcWidth)/width;
+    float scaleY = static_cast<float>(srcHeight)/height;
+    for (int y = 0; y < height; y++)
+    {
+        // Samples at texel centers
+        float v = std::max(0.0f, (y+0.5f)*scaleY - 0.5f);
+        int y0 = std::min(static_cast<int>(v), srcHeight-1);
+        int y1 = std::min(y0+1, srcHeight-1);
+        float fy = v - y0;
+        for (int x = 0; x < width; x++)
+        {
+            float u = std::max(0.0f, (x+0.5f)*scaleX - 0.5f);
+            int x0 = std::min(static_cast<int>(u), srcWidth-1);
+            int x1 = std::min(x0+1, srcWidth-1);
+            float fx = u - x0;
+            for (int c = 0; c < 4; c++)
+            {
+                float top = src[(static_cast<size_t>(y0)*srcWidth+x0)*4+c]*(1-fx) + src[(static_cast<size_t>(y0)*srcWidth+x1)*4+c]*fx;
+                float bottom = src[(static_cast<size_t>(y1)*srcWidth+x0)*4+c]*(1-fx) + src[(static_cast<size_t>(y1)*srcWidth+x1)*4+c]*fx;
+                dst[(static_cast<size_t>(y)*width+x)*4+c] = static_cast<unsigned char>(top*(1-fy) + bottom*fy + 0.5f);
+            }
+        }
+    }
+    return dst;
+}
+
+// @param pool Decodes the images, must outlive the loader.
+TextureLoader::TextureLoader(ThreadPool *pool, double uploadBudget) :
+    m_pool {pool},
+    m_uploadBudget {uploadBudget}
+{
+    glGenBuffers(1, &m_PBO);
+    m_cachePath = (std::filesystem::path(m_imgPath) / "cache").string() + static_cast<char>(std::filesystem::path::preferred_separator);
+    std::error_code error;
+    std::filesystem::create_directories(m_cachePath, error);
+}
+
+// @brief Waits for the decodes in flight and drops the images that were never uploaded.
+TextureLoader::~TextureLoader()
+{
+    for (auto &pending: m_pending)
+    {
+        pending.wait();
+    }
+    for (auto &image: m_decoded)
+    {
+        if (image.data)
+            stbi_image_free(image.data);
+        image.ready->set_value(false);
+    }
+    glDeleteBuffers(1, &m_PBO);
+}
+
+// @brief Gives the texture a placeholder and queues the decoding of the image.
+// @param texture Texture name, generated by the caller, that receives the image once decoded.
+// @param img File name of the image in the img folder.
+// @return Becomes true once the image is uploaded, false if it could not be decoded.
+// @note Must be called from the GL thread.
+std::shared_future<bool>
+TextureLoader::Load(unsigned int texture, const std::string &img)
+{
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER);
+    return __Queue({texture, -1, nullptr, 0, 0, 0, nullptr, nullptr, {}, {}}, img);
+}
+
+// @brief Queues the decoding of an image into a layer of a texture array, resized to the layer size.
+// @param texture GL_TEXTURE_2D_ARRAY with RGBA8 storage for its whole mip chain, width x height per layer.
+// @return Becomes true once every level of the layer is uploaded, false if the image could not be decoded.
+// @note The array's storage must exist by the time Update() uploads the layer: it keeps its previous content until then.
+std::shared_future<bool>
+TextureLoader::LoadLayer(unsigned int texture, int layer, int width, int height, const std::string &img)
+{
+    return __Queue({texture, layer, nullptr, width, height, 4, nullptr, nullptr, {}, {}}, img);
+}
+
+// @brief Decodes the image on the thread pool, Update() uploads it.
+std::shared_future<bool>
+TextureLoader::__Queue(DecodedImage image, const std::string &img)
+{
+    auto ready = std::make_shared<std::promise<bool>>();
+    std::shared_future<bool> future = ready->get_future().share();
+    image.ready = ready;
+
+    m_pending.emplace_back(m_pool->Submit([this, image, img, ready]() mutable
+    {
+        if (image.layer >= 0)
+            __DecodeLayer(image, img);
+        else
+            __Decode(image, img);
+        if (!image.data && !image.cache && image.levelData.empty())
+        {
+            ready->set_value(false);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_decoded.emplace_back(std::move(image));
+    }));
+    return future;
+}
+
+// @brief Uploads the decoded images until the frame's time budget is spent.
+// @return The number of textures uploaded.
+// @note Call once per frame from the GL thread. At least one image is uploaded per call so that
+// loading always progresses, even with a budget smaller than a single upload.
+unsigned int
+TextureLoader::Update()
+{
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    unsigned int uploaded = 0;
+
+    while (true)
+    {
+        DecodedImage image;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_decoded.empty())
+                break;
+            image = std::move(m_decoded.front());
+            m_decoded.pop_front();
+        }
+        if (image.layer >= 0)
+            __UploadLayer(image);
+        else if (image.cache)
+            __UploadCache(image);
+        else
+            __Upload(image);
+        uploaded++;
+
+        std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+        if (elapsed.count() >= m_uploadBudget)
+            break;
+    }
+
+    // Forget about the decodes that are over
+    for (size_t i = 0; i < m_pending.size();)
+    {
+        if (m_pending[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            m_pending[i] = std::move(m_pending.back());
+            m_pending.pop_back();
+        }
+        else
+        {
+            i++;
+        }
+    }
+    return uploaded;
+}
+
+// @brief True once every queued image is either uploaded or failed.
+bool
+TextureLoader::IsIdle()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_decoded.empty() && m_pending.empty();
+}
+
+// @brief Worker side: maps the cache file if it is up to date, otherwise decodes the image and refreshes the cache.
+void
+TextureLoader::__Decode(DecodedImage &image, const std::string &img)
+{
+    std::string path = m_imgPath + img;
+    std::string cachePath = m_cachePath + img + ".ftx";
+    MappedFile source;
+    if (!source.Open(path))
+    {
+        std::cout << "Failed to open the 2D texture image " << path << ".\n";
+        return;
+    }
+    std::uint64_t hash = Hash64(source.GetData(), source.GetSize());
+
+    // Without S3TC, a BC1 cache (see texture_cache --bc1) is ignored: the image is decoded and uploaded uncompressed,
+    // and its cache rewritten in RGBA8
+    auto cache = std::make_shared<TextureCache>();
+    if (cache->Open(cachePath, hash) && (!cache->IsCompressed() || GLCaps::HasTextureCompressionS3TC()))
+    {
+        image.cache = std::move(cache);
+        return;
+    }
+    cache.reset();
+
+    image.data = stbi_load_from_memory(source.GetData(), static_cast<int>(source.GetSize()),
+                                       &image.width, &image.height, &image.channels, 0);
+    if (!image.data)
+    {
+        std::cout << "Failed to decode the 2D texture image " << path << ".\n";
+        return;
+    }
+    TextureCache::Write(cachePath, hash, image.data, image.width, image.height, image.channels);
+}
+
+// @brief Worker side of LoadLayer(): maps the layer's cache file if it is up to date, otherwise decodes and resizes
+// the image, builds its mip chain and refreshes the cache.
+// @note Cached apart from the image's own cache, the file name tells the layer size.
+void
+TextureLoader::__DecodeLayer(DecodedImage &image, const std::string &img)
+{
+    std::string path = m_imgPath + img;
+    std::string cachePath = m_cachePath + img + "." + std::to_string(image.width) + "x" + std::to_string(image.height) + ".ftx";
+    MappedFile source;
+    if (!source.Open(path))
+    {
+        std::cout << "Failed to open the texture array layer " << path << ".\n";
+        return;
+    }
+    std::uint64_t hash = Hash64(source.GetData(), source.GetSize());
+
+    auto cache = std::make_shared<TextureCache>();
+    if (cache->Open(cachePath, hash) && cache->GetHeader().format == TextureCache::FORMAT_RGBA8
+        && cache->GetHeader().width == static_cast<std::uint32_t>(image.width)
+        && cache->GetHeader().height == static_cast<std::uint32_t>(image.height))
+    {
+        image.cache = std::move(cache);
+        return;
+    }
+
+    int width, height, channels;
+    unsigned char *data = stbi_load_from_memory(source.GetData(), static_cast<int>(source.GetSize()),
+                                                &width, &height, &channels, 4);
+    if (!data)
+    {
+        std::cout << "Failed to decode the texture array layer " << path << ".\n";
+        return;
+    }
+    std::vector<unsigned char> pixels = Resize(data, width, height, image.width, image.height);
+    stbi_image_free(data);
+    TextureCache::BuildLevels(pixels.data(), image.width, image.height, 4, TextureCache::FORMAT_RGBA8,
+                              image.levels, image.levelData);
+    // Uploaded from memory whether or not the cache could be written
+    TextureCache::WriteLevels(cachePath, hash, TextureCache::FORMAT_RGBA8, image.levels, image.levelData);
+}
+
+// @brief Uploads every level of a cached mip chain straight from the mapped file.
+void
+TextureLoader::__UploadCache(DecodedImage &image)
+{
+    const TextureCache &cache = *image.cache;
+    unsigned int levels = cache.GetHeader().levels;
+
+    glBindTexture(GL_TEXTURE_2D, image.texture);
+    for (unsigned int i = 0; i < levels; i++)
+    {
+        const TextureCache::Level &level = cache.GetLevel(i);
+        if (cache.IsCompressed())
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, cache.GetHeader().format, level.width, level.height, 0,
+                                   static_cast<GLsizei>(level.size), cache.GetLevelData(i));
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                         cache.GetLevelData(i));
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels-1);
+
+    image.cache.reset();
+    image.ready->set_value(true);
+}
+
+// @brief Streams the pixels through the PBO and replaces the placeholder.
+void
+TextureLoader::__Upload(DecodedImage &image)
+{
+    GLsizeiptr size = static_cast<GLsizeiptr>(image.width)*image.height*image.channels;
+    GLenum format = PixelFormat(image.channels);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PBO);
+    // Orphans the previous storage so that the driver doesn't wait for the last upload to finish
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void *staging = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (staging)
+    {
+        std::memcpy(staging, image.data, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    else
+    {
+        // Falls back to a client memory upload
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, image.texture);
+    // Rows of 1 or 3 channels images are not 4-bytes aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE,
+                 staging ? nullptr : image.data);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    stbi_image_free(image.data);
+    image.ready->set_value(true);
+}
+
+// @brief Uploads every level of a layer, from its cache file or from the chain the worker built.
+void
+TextureLoader::__UploadLayer(DecodedImage &image)
+{
+    unsigned int levels = image.cache ? image.cache->GetHeader().levels : static_cast<unsigned int>(image.levels.size());
+    glBindTexture(GL_TEXTURE_2D_ARRAY, image.texture);
+    for (unsigned int i = 0; i < levels; i++)
+    {
+        const TextureCache::Level &level = image.cache ? image.cache->GetLevel(i) : image.levels[i];
+        const unsigned char *pixels = image.cache ? image.cache->GetLevelData(i) : image.levelData[i].data();
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, image.layer, level.width, level.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+
+    image.cache.reset();
+    image.levelData.clear();
+    image.ready->set_value(true);
+}
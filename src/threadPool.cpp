@@ -0,0 +1,130 @@
+#include "threadPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+    if (!threadCount)
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        threadCount = cores > 1 ? cores-1 : 1;
+    }
+    m_workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++)
+    {
+        m_workers.emplace_back(&ThreadPool::__Work, this);
+    }
+}
+
+// @brief Runs the tasks already queued, then joins every worker.
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    for (auto &worker: m_workers)
+    {
+        worker.join();
+    }
+}
+
+// @brief Worker loop: pops and runs tasks until the pool is stopped and empty.
+void ThreadPool::__Work()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || m_taskCount; });
+            if (m_stop && !m_taskCount)
+                return;
+            task = std::move(m_tasks[m_taskHead]);
+            m_tasks[m_taskHead] = nullptr;
+            m_taskHead = (m_taskHead+1) % m_tasks.size();
+            m_taskCount--;
+        }
+        task();
+    }
+}
+
+// @brief Queues a task, the ring buffer only grows when it is full.
+void ThreadPool::__Push(std::function<void()> &&task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_taskCount == m_tasks.size())
+        {
+            std::vector<std::function<void()>> tasks(std::max<size_t>(2*m_tasks.size(), 16));
+            for (size_t i = 0; i < m_taskCount; i++)
+            {
+                tasks[i] = std::move(m_tasks[(m_taskHead+i) % m_tasks.size()]);
+            }
+            m_tasks.swap(tasks);
+            m_taskHead = 0;
+        }
+        m_tasks[(m_taskHead+m_taskCount) % m_tasks.size()] = std::move(task);
+        m_taskCount++;
+    }
+    m_condition.notify_one();
+}
+
+// @brief Claims batches of the current job until none is left.
+void ThreadPool::__RunBatches()
+{
+    while (true)
+    {
+        size_t batch = m_job.nextBatch.fetch_add(1);
+        if (batch >= m_job.batchCount)
+            return;
+        size_t begin = batch*m_job.batchSize;
+        m_job.run(m_job.context, begin, std::min(begin + m_job.batchSize, m_job.count));
+        m_job.doneBatches.fetch_add(1);
+    }
+}
+
+void ThreadPool::__ParallelFor(size_t count, size_t batchSize, void (*run)(void *, size_t, size_t), void *context)
+{
+    batchSize = std::max<size_t>(batchSize, 1);
+    size_t batchCount = (count + batchSize-1) / batchSize;
+    if (batchCount <= 1 || m_workers.empty())
+    {
+        if (count)
+            run(context, 0, count);
+        return;
+    }
+
+    m_job.run = run;
+    m_job.context = context;
+    m_job.count = count;
+    m_job.batchSize = batchSize;
+    m_job.batchCount = batchCount;
+    m_job.nextBatch = 0;
+    m_job.doneBatches = 0;
+    m_job.open = true;
+
+    // Helpers only capture the pool: they fit in std::function's small buffer and don't allocate
+    size_t helpers = std::min<size_t>(m_workers.size(), batchCount-1);
+    for (size_t i = 0; i < helpers; i++)
+    {
+        __Push([this]()
+        {
+            // A helper starting after its job closed leaves without touching it
+            m_job.activeHelpers.fetch_add(1);
+            if (m_job.open)
+                __RunBatches();
+            m_job.activeHelpers.fetch_sub(1);
+        });
+    }
+
+    __RunBatches();
+    while (m_job.doneBatches.load() < batchCount)
+        std::this_thread::yield();
+    // No helper may still be reading the job when the next one overwrites it
+    m_job.open = false;
+    while (m_job.activeHelpers.load())
+        std::this_thread::yield();
+}
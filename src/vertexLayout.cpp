@@ -0,0 +1,199 @@
+#include "vertexLayout.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Every attribute starts on a 4-byte boundary, as GPUs fetch them best
+static constexpr unsigned int ATTRIBUTE_ALIGNMENT = 4;
+
+static unsigned int
+TypeSize(GLenum type)
+{
+    switch (type)
+    {
+    case GL_UNSIGNED_BYTE:
+        return 1;
+    case GL_HALF_FLOAT:
+    case GL_UNSIGNED_SHORT:
+    case GL_SHORT:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+// @brief In bytes, the storage of one attribute before alignment.
+unsigned int VertexLayout::AttributeSize(unsigned int components, GLenum type)
+{
+    // The 4 components are packed in a single 32-bit word
+    if (type == GL_INT_2_10_10_10_REV)
+        return 4;
+    return components*TypeSize(type);
+}
+
+// @brief Appends an attribute at the end of its stream.
+// @param sourceOffset In floats, where the attribute is in the source vertices given to Convert().
+// @return The layout itself, so that calls can be chained.
+VertexLayout &VertexLayout::Add(unsigned int index, unsigned int components, GLenum type, bool normalized,
+                                unsigned int sourceOffset, unsigned int stream)
+{
+    if (stream >= m_strides.size())
+        m_strides.resize(stream+1, 0);
+
+    m_attributes.push_back({index, components, type, normalized, sourceOffset, stream, m_strides[stream]});
+    unsigned int size = AttributeSize(components, type);
+    m_strides[stream] += (size + ATTRIBUTE_ALIGNMENT-1) & ~(ATTRIBUTE_ALIGNMENT-1);
+    return *this;
+}
+
+// @brief IEEE 754 binary32 to binary16, rounded to nearest even.
+unsigned short VertexLayout::ToHalf(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    std::uint32_t sign = (bits >> 16) & 0x8000;
+    std::uint32_t exponent = (bits >> 23) & 0xFF;
+    std::uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0xFF)
+        return static_cast<unsigned short>(sign | 0x7C00 | (mantissa ? 0x200 : 0)); // Inf or NaN
+    int halfExponent = static_cast<int>(exponent) - 127 + 15;
+    if (halfExponent >= 31)
+        return static_cast<unsigned short>(sign | 0x7C00); // Overflows to Inf
+    if (halfExponent <= 0)
+    {
+        // Subnormal half, or zero
+        if (halfExponent < -10)
+            return static_cast<unsigned short>(sign);
+        mantissa |= 0x800000;
+        unsigned int shift = static_cast<unsigned int>(14 - halfExponent);
+        std::uint32_t half = mantissa >> shift;
+        std::uint32_t rest = mantissa & ((1u << shift) - 1);
+        std::uint32_t halfway = 1u << (shift-1);
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            half++;
+        return static_cast<unsigned short>(sign | half);
+    }
+    std::uint32_t half = sign | (static_cast<std::uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    std::uint32_t rest = mantissa & 0x1FFF;
+    // A carry into the exponent is the correct rounding as well
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        half++;
+    return static_cast<unsigned short>(half);
+}
+
+static std::int32_t
+ToSnorm(float value, int bits)
+{
+    float scale = static_cast<float>((1 << (bits-1)) - 1);
+    return static_cast<std::int32_t>(std::lround(std::clamp(value, -1.0f, 1.0f)*scale));
+}
+
+static std::uint32_t
+ToUnorm(float value, int bits)
+{
+    float scale = static_cast<float>((1u << bits) - 1);
+    return static_cast<std::uint32_t>(std::lround(std::clamp(value, 0.0f, 1.0f)*scale));
+}
+
+// @brief Writes one attribute of one vertex in its GPU type.
+static void
+Pack(const VertexLayout::Attribute &attribute, const float *source, unsigned char *destination)
+{
+    if (attribute.type == GL_INT_2_10_10_10_REV)
+    {
+        // x, y, z on 10 bits and w on 2 bits, all signed normalized
+        std::uint32_t packed = 0;
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            float value = c < attribute.components ? source[c] : 0.0f;
+            int bits = c < 3 ? 10 : 2;
+            std::uint32_t field = static_cast<std::uint32_t>(ToSnorm(value, bits)) & ((1u << bits) - 1);
+            packed |= field << (10*c);
+        }
+        std::memcpy(destination, &packed, sizeof(packed));
+        return;
+    }
+
+    for (unsigned int c = 0; c < attribute.components; c++)
+    {
+        float value = source[c];
+        switch (attribute.type)
+        {
+        case GL_HALF_FLOAT:
+        {
+            unsigned short half = VertexLayout::ToHalf(value);
+            std::memcpy(destination + 2*c, &half, sizeof(half));
+            break;
+        }
+        case GL_UNSIGNED_SHORT:
+        {
+            unsigned short unorm = static_cast<unsigned short>(attribute.normalized ? ToUnorm(value, 16) : std::lround(value));
+            std::memcpy(destination + 2*c, &unorm, sizeof(unorm));
+            break;
+        }
+        case GL_SHORT:
+        {
+            short snorm = static_cast<short>(attribute.normalized ? ToSnorm(value, 16) : std::lround(value));
+            std::memcpy(destination + 2*c, &snorm, sizeof(snorm));
+            break;
+        }
+        case GL_UNSIGNED_BYTE:
+            destination[c] = static_cast<unsigned char>(attribute.normalized ? ToUnorm(value, 8) : std::lround(value));
+            break;
+        default:
+            std::memcpy(destination + 4*c, &value, sizeof(value));
+            break;
+        }
+    }
+}
+
+// @brief Builds the GPU buffers of every stream from interleaved float vertices.
+// @param sourceStride In floats, the size of one source vertex.
+// @return One byte array per stream, to upload as is.
+std::vector<std::vector<unsigned char>>
+VertexLayout::Convert(const float *vertices, size_t vertexCount, unsigned int sourceStride) const
+{
+    std::vector<std::vector<unsigned char>> streams(m_strides.size());
+    for (size_t s = 0; s < streams.size(); s++)
+    {
+        streams[s].assign(vertexCount*m_strides[s], 0);
+    }
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        const float *source = vertices + v*sourceStride;
+        for (auto &attribute: m_attributes)
+        {
+            unsigned char *destination = streams[attribute.stream].data() + v*m_strides[attribute.stream] + attribute.offset;
+            Pack(attribute, source + attribute.sourceOffset, destination);
+        }
+    }
+    return streams;
+}
+
+// @brief Whether every stream holds an attribute.
+// @note Adding attributes to stream 2 alone leaves streams 0 and 1 empty: with a stride of 0, nothing tells their
+// vertex count, so such layouts are rejected wherever buffers are built from them.
+bool VertexLayout::IsValid() const
+{
+    return !m_strides.empty() && std::find(m_strides.begin(), m_strides.end(), 0u) == m_strides.end();
+}
+
+// @brief Whether vertices of both layouts can share the same buffers and Vertex Array.
+// @note Only the GPU side is compared, the source offsets given to Convert() may differ.
+bool VertexLayout::IsCompatible(const VertexLayout &other) const
+{
+    if (m_strides != other.m_strides || m_attributes.size() != other.m_attributes.size())
+        return false;
+    for (size_t i = 0; i < m_attributes.size(); i++)
+    {
+        const Attribute &a = m_attributes[i];
+        const Attribute &b = other.m_attributes[i];
+        if (a.index != b.index || a.components != b.components || a.type != b.type || a.normalized != b.normalized
+            || a.stream != b.stream || a.offset != b.offset)
+            return false;
+    }
+    return true;
+}
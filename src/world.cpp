@@ -0,0 +1,153 @@
+#include "world.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+World::~World()
+{
+    for (auto &archetype: m_archetypes)
+    {
+        for (unsigned char *chunk: archetype->chunks)
+        {
+            ::operator delete(chunk, std::align_val_t(CACHE_LINE));
+        }
+    }
+}
+
+std::uint32_t World::__RegisterComponent(size_t size, size_t alignment)
+{
+    if (s_componentCount == MAX_COMPONENTS || alignment > CACHE_LINE)
+    {
+        std::cerr << "Failed to register a component: " << MAX_COMPONENTS << " types at most, aligned on "
+                  << CACHE_LINE << " bytes at most" << std::endl;
+        std::abort();
+    }
+    s_componentSizes[s_componentCount] = size;
+    return s_componentCount++;
+}
+
+// @brief The archetype of this set of components, created with its chunk layout on first use.
+World::Archetype *World::__GetArchetype(Mask mask)
+{
+    for (auto &archetype: m_archetypes)
+    {
+        if (archetype->mask == mask)
+            return archetype.get();
+    }
+
+    auto archetype = std::make_unique<Archetype>();
+    archetype->mask = mask;
+    archetype->offsets.fill(0);
+    size_t entitySize = sizeof(EntityId);
+    for (std::uint32_t c = 0; c < s_componentCount; c++)
+    {
+        if (mask & (Mask(1) << c))
+            entitySize += s_componentSizes[c];
+    }
+
+    // The most entities whose arrays, each padded to a cache line, fit in a chunk
+    auto align = [](size_t offset) { return (offset + CACHE_LINE-1) & ~(CACHE_LINE-1); };
+    for (size_t capacity = CHUNK_SIZE / entitySize; capacity; capacity--)
+    {
+        size_t offset = 0;
+        archetype->idOffset = offset;
+        offset = align(offset + capacity*sizeof(EntityId));
+        for (std::uint32_t c = 0; c < s_componentCount; c++)
+        {
+            if (!(mask & (Mask(1) << c)))
+                continue;
+            archetype->offsets[c] = offset;
+            offset = align(offset + capacity*s_componentSizes[c]);
+        }
+        if (offset <= CHUNK_SIZE)
+        {
+            archetype->capacity = capacity;
+            break;
+        }
+    }
+
+    m_archetypes.push_back(std::move(archetype));
+    return m_archetypes.back().get();
+}
+
+void World::__Reserve(Archetype *archetype, size_t count)
+{
+    size_t chunks = (archetype->count + count + archetype->capacity-1) / archetype->capacity;
+    while (archetype->chunks.size() < chunks)
+    {
+        archetype->chunks.push_back(static_cast<unsigned char *>(::operator new(CHUNK_SIZE, std::align_val_t(CACHE_LINE))));
+    }
+    m_records.Reserve(m_records.GetCount() + count);
+}
+
+EntityId World::__NewId()
+{
+    // Grows geometrically when Reserve() wasn't called
+    if (m_records.GetCount() == m_records.GetCapacity())
+        m_records.Reserve(std::max<size_t>(64, 2*m_records.GetCapacity()));
+    RecordPool::Handle handle = m_records.Spawn(Record{nullptr, 0});
+    return {handle.slot, handle.generation};
+}
+
+// @brief Appends a row to the archetype for the entity, a chunk is only allocated when none is spare.
+size_t World::__AllocateRow(Archetype *archetype, EntityId id)
+{
+    size_t row = archetype->count;
+    if (row / archetype->capacity == archetype->chunks.size())
+        __Reserve(archetype, 1);
+    archetype->count++;
+
+    unsigned char *chunk = archetype->chunks[row / archetype->capacity];
+    reinterpret_cast<EntityId *>(chunk + archetype->idOffset)[row % archetype->capacity] = id;
+    __Record(id) = {archetype, row};
+    return row;
+}
+
+// @brief Fills the row with the archetype's last entity.
+void World::__RemoveRow(Archetype *archetype, size_t row)
+{
+    size_t last = archetype->count-1;
+    if (row != last)
+    {
+        for (std::uint32_t c = 0; c < s_componentCount; c++)
+        {
+            if (archetype->mask & (Mask(1) << c))
+                std::memcpy(__Component(archetype, row, c), __Component(archetype, last, c), s_componentSizes[c]);
+        }
+        EntityId *rowId = reinterpret_cast<EntityId *>(archetype->chunks[row / archetype->capacity] + archetype->idOffset)
+                        + row % archetype->capacity;
+        *rowId = reinterpret_cast<EntityId *>(archetype->chunks[last / archetype->capacity] + archetype->idOffset)[last % archetype->capacity];
+        __Record(*rowId).row = row;
+    }
+    archetype->count--;
+}
+
+// @brief Moves the entity to the archetype of the given components, keeping the ones both have.
+void World::__MoveEntity(EntityId id, Mask mask)
+{
+    Archetype *from = __Record(id).archetype;
+    size_t fromRow = __Record(id).row;
+    Archetype *to = __GetArchetype(mask);
+    size_t toRow = __AllocateRow(to, id);
+    for (std::uint32_t c = 0; c < s_componentCount; c++)
+    {
+        if (from->mask & mask & (Mask(1) << c))
+            std::memcpy(__Component(to, toRow, c), __Component(from, fromRow, c), s_componentSizes[c]);
+    }
+    __RemoveRow(from, fromRow);
+}
+
+// @brief Destroys the entity in O(1): the last entity of its archetype takes its place.
+// @return false if the entity was already destroyed.
+bool World::Destroy(EntityId id)
+{
+    if (!IsAlive(id))
+        return false;
+
+    const Record &record = __Record(id);
+    __RemoveRow(record.archetype, record.row);
+    m_records.Despawn(__Handle(id));
+    return true;
+}
@@ -0,0 +1,155 @@
+// Checks MeshBuilder's deduplication and cache ordering on two cubes, both drawn from 36 unindexed vertices:
+// - with a normal per face, each face keeps its own 4 corners: 24 unique vertices;
+// - the built-in cube of main.cpp, positions and texture coordinates only, whose side faces share 8 corners
+//   with their neighbours: 16 unique vertices.
+// Once optimized, each unique vertex must be transformed only once, and the triangles must be the input's.
+// Usage: mesh_builder_test
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "meshBuilder.hpp"
+
+// Same triangle list as the cube of main.cpp: position, texture coordinates
+static const float MAIN_CUBE[] = {
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+     0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+};
+
+// Position, texture coordinates, normal
+static constexpr unsigned int NORMAL_STRIDE = 8;
+
+// @brief A unit cube with a normal per face, as an unindexed triangle list.
+static std::vector<float>
+CubeWithNormals()
+{
+    std::vector<float> vertices;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (float side: {-1.0f, 1.0f})
+        {
+            // The face's quad as two triangles, each corner as (u, v) in {0, 1}
+            static const int corners[6][2] = {{0, 0}, {1, 0}, {1, 1}, {1, 1}, {0, 1}, {0, 0}};
+            for (auto &corner: corners)
+            {
+                float position[3];
+                position[axis] = 0.5f*side;
+                position[(axis+1)%3] = corner[0] - 0.5f;
+                position[(axis+2)%3] = corner[1] - 0.5f;
+                float normal[3] = {};
+                normal[axis] = side;
+                vertices.insert(vertices.end(), {position[0], position[1], position[2],
+                                                 static_cast<float>(corner[0]), static_cast<float>(corner[1]),
+                                                 normal[0], normal[1], normal[2]});
+            }
+        }
+    }
+    return vertices;
+}
+
+// @brief Corners of each triangle, rotated to start from the smallest: the same triangle whatever corner
+// the indexed mesh starts it from, with its winding kept.
+static std::vector<std::vector<float>>
+Triangles(const float *vertices, const unsigned int *indices, size_t indexCount, unsigned int stride)
+{
+    std::vector<std::vector<float>> triangles;
+    for (size_t i = 0; i+2 < indexCount; i += 3)
+    {
+        std::vector<std::vector<float>> corners;
+        for (size_t c = 0; c < 3; c++)
+        {
+            const float *vertex = vertices + (indices ? indices[i+c] : i+c)*stride;
+            corners.emplace_back(vertex, vertex + stride);
+        }
+        std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+        std::vector<float> triangle;
+        for (auto &corner: corners)
+        {
+            triangle.insert(triangle.end(), corner.begin(), corner.end());
+        }
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// @return The number of failed checks.
+static int
+Check(const char *name, const float *vertices, size_t vertexCount, unsigned int stride, size_t expectedUnique)
+{
+    MeshBuilder builder(vertices, vertexCount, stride);
+    builder.Optimize();
+    const std::vector<unsigned int> &indices = builder.GetIndices();
+    unsigned int transforms = MeshBuilder::CountTransforms(indices.data(), indices.size());
+    std::cout << name << ": " << builder.GetInputVertexCount() << " vertices -> " << builder.GetVertexCount() << " unique, "
+              << transforms << " vertex shader invocations instead of " << vertexCount << std::endl;
+
+    int failures = 0;
+    if (builder.GetVertexCount() != expectedUnique || indices.size() != vertexCount)
+    {
+        std::cerr << "FAILED: " << name << ": expected " << expectedUnique << " unique vertices and " << vertexCount
+                  << " indices" << std::endl;
+        failures++;
+    }
+    // Every unique vertex fits in the cache: each one is transformed once
+    if (transforms != expectedUnique)
+    {
+        std::cerr << "FAILED: " << name << ": expected " << expectedUnique << " vertex shader invocations" << std::endl;
+        failures++;
+    }
+    if (Triangles(builder.GetVertices().data(), indices.data(), indices.size(), stride)
+        != Triangles(vertices, nullptr, vertexCount, stride))
+    {
+        std::cerr << "FAILED: " << name << ": the indexed triangles aren't the input's" << std::endl;
+        failures++;
+    }
+    return failures;
+}
+
+int main()
+{
+    std::vector<float> cube = CubeWithNormals();
+    int failures = Check("Cube with normals", cube.data(), cube.size()/NORMAL_STRIDE, NORMAL_STRIDE, 24);
+    failures += Check("Built-in cube", MAIN_CUBE, sizeof(MAIN_CUBE)/sizeof(float)/5, 5, 16);
+    return failures ? 1 : 0;
+}
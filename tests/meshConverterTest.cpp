@@ -0,0 +1,96 @@
+// Checks that every level of detail written by mesh_converter keeps every material group of the model.
+// Usage: mesh_converter_test <mesh_converter> <scratch folder>
+// The model is a sphere, which simplifies well, and a quad in another material, which can't get any simpler:
+// the quad must still be in the coarsest level.
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "meshFile.hpp"
+
+static constexpr unsigned int LOD_COUNT = 4;
+
+static void
+WriteModel(const std::string &path)
+{
+    std::ofstream file(path);
+    const int rings = 16;
+    const int segments = 32;
+    for (int ring = 0; ring <= rings; ring++)
+    {
+        float theta = 3.14159265f*ring/rings;
+        for (int segment = 0; segment < segments; segment++)
+        {
+            float phi = 2.0f*3.14159265f*segment/segments;
+            file << "v " << std::sin(theta)*std::cos(phi) << " " << std::cos(theta) << " " << std::sin(theta)*std::sin(phi) << "\n";
+        }
+    }
+    file << "usemtl sphere\n";
+    for (int ring = 0; ring < rings; ring++)
+    {
+        for (int segment = 0; segment < segments; segment++)
+        {
+            int a = ring*segments + segment + 1;
+            int b = ring*segments + (segment+1)%segments + 1;
+            file << "f " << a << " " << b << " " << b+segments << " " << a+segments << "\n";
+        }
+    }
+    file << "v 2 0 0\nv 3 0 0\nv 3 1 0\nv 2 1 0\n";
+    file << "usemtl quad\nf -4 -3 -2 -1\n";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: mesh_converter_test <mesh_converter> <scratch folder>" << std::endl;
+        return 1;
+    }
+    std::string model = std::string(argv[2]) + "/lodGroups.obj";
+    std::string mesh = std::string(argv[2]) + "/lodGroups.fmesh";
+    WriteModel(model);
+    std::string command = std::string("\"") + argv[1] + "\" --lods " + std::to_string(LOD_COUNT) + " \"" + model + "\" \"" + mesh + "\"";
+    if (std::system(command.c_str()) != 0)
+    {
+        std::cerr << "FAILED: " << command << std::endl;
+        return 1;
+    }
+
+    MeshFile file;
+    if (!file.Open(mesh))
+        return 1;
+    std::vector<unsigned int> groups(LOD_COUNT+1);
+    std::vector<unsigned int> triangles(LOD_COUNT+1);
+    for (std::uint32_t i = 0; i < file.GetHeader().submeshCount; i++)
+    {
+        const MeshFile::Submesh &submesh = file.GetSubmeshes()[i];
+        if (submesh.lod > LOD_COUNT || !submesh.indexCount)
+        {
+            std::cerr << "FAILED: submesh " << i << " has lod " << submesh.lod << " and " << submesh.indexCount << " indices" << std::endl;
+            return 1;
+        }
+        groups[submesh.lod]++;
+        triangles[submesh.lod] += submesh.indexCount/3;
+    }
+
+    int failures = 0;
+    for (unsigned int lod = 0; lod <= LOD_COUNT; lod++)
+    {
+        std::cout << "lod " << lod << ": " << groups[lod] << " groups, " << triangles[lod] << " triangles" << std::endl;
+        if (groups[lod] != groups[0])
+        {
+            std::cerr << "FAILED: lod " << lod << " has " << groups[lod] << " groups instead of " << groups[0] << std::endl;
+            failures++;
+        }
+    }
+    if (groups[0] != 2)
+    {
+        std::cerr << "FAILED: expected 2 groups in lod 0, got " << groups[0] << std::endl;
+        failures++;
+    }
+    return failures ? 1 : 0;
+}
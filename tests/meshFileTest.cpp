@@ -0,0 +1,138 @@
+// Checks that MeshFile::Open() rejects truncated and corrupt files instead of handing out tables past their end.
+// Usage: mesh_file_test <scratch folder>
+// A valid two-stream mesh is written, then copies of it with one field broken each: every copy must fail to open.
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "meshFile.hpp"
+
+static std::vector<unsigned char>
+ReadBytes(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void
+WriteBytes(const std::string &path, const std::vector<unsigned char> &bytes, size_t size)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(bytes.data()), size);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: mesh_file_test <scratch folder>" << std::endl;
+        return 1;
+    }
+    std::string valid = std::string(argv[1]) + "/valid.fmesh";
+    std::string broken = std::string(argv[1]) + "/broken.fmesh";
+
+    // A quad: positions in stream 0, texture coordinates and normals in stream 1
+    const float vertices[] = {
+        0, 0, 0,  0, 0,  0, 0, 1,
+        1, 0, 0,  1, 0,  0, 0, 1,
+        1, 1, 0,  1, 1,  0, 0, 1,
+        0, 1, 0,  0, 1,  0, 0, 1,
+    };
+    VertexLayout layout;
+    layout.Add(0, 3, GL_FLOAT, false, 0, 0)
+          .Add(1, 2, GL_HALF_FLOAT, false, 3, 1)
+          .Add(3, 3, GL_INT_2_10_10_10_REV, true, 5, 1);
+    const float boundsMin[3] = {0, 0, 0};
+    const float boundsMax[3] = {1, 1, 0};
+    if (!MeshFile::Write(valid, layout, layout.Convert(vertices, 4, 8), 4, {0, 1, 2, 0, 2, 3}, {{0, 6, 0, 0}},
+                         boundsMin, boundsMax))
+    {
+        std::cerr << "FAILED: writing " << valid << std::endl;
+        return 1;
+    }
+
+    MeshFile file;
+    if (!file.Open(valid))
+    {
+        std::cerr << "FAILED: the valid mesh doesn't open" << std::endl;
+        return 1;
+    }
+    const MeshFile::Header header = file.GetHeader();
+    const std::vector<unsigned char> bytes = ReadBytes(valid);
+
+    int failures = 0;
+    auto expectInvalid = [&](const std::string &name, const std::vector<unsigned char> &corrupt, size_t size)
+    {
+        WriteBytes(broken, corrupt, size);
+        MeshFile brokenFile;
+        if (brokenFile.Open(broken))
+        {
+            std::cerr << "FAILED: " << name << " opens" << std::endl;
+            failures++;
+        }
+    };
+    // Overwrites a field of the file, at its offset from the start
+    auto corrupt = [&](const std::string &name, size_t offset, const void *value, size_t size)
+    {
+        std::vector<unsigned char> copy = bytes;
+        std::memcpy(copy.data() + offset, value, size);
+        expectInvalid(name, copy, copy.size());
+    };
+    auto corrupt32 = [&](const std::string &name, size_t offset, std::uint32_t value)
+    {
+        corrupt(name, offset, &value, sizeof(value));
+    };
+    auto corrupt64 = [&](const std::string &name, size_t offset, std::uint64_t value)
+    {
+        corrupt(name, offset, &value, sizeof(value));
+    };
+
+    // Truncated anywhere: in the header, the tables, the streams or the indices
+    for (size_t size: {size_t(0), sizeof(MeshFile::Header)/2, size_t(header.attributeOffset + 4), size_t(header.submeshOffset + 4),
+                       size_t(header.streamOffsets[1] + 4), bytes.size() - 1})
+    {
+        expectInvalid("truncated to " + std::to_string(size) + " bytes", bytes, size);
+    }
+
+    corrupt32("vertex count past the streams", offsetof(MeshFile::Header, vertexCount), 0x40000000);
+    corrupt32("index count past the indices", offsetof(MeshFile::Header, indexCount), 0xFFFFFFFF);
+    corrupt32("attribute count past the table", offsetof(MeshFile::Header, attributeCount), 0x10000000);
+    corrupt32("submesh count past the table", offsetof(MeshFile::Header, submeshCount), 0x10000000);
+    corrupt32("too many streams", offsetof(MeshFile::Header, streamCount), MeshFile::MAX_STREAMS+1);
+    corrupt32("index type", offsetof(MeshFile::Header, indexType), GL_FLOAT);
+    corrupt32("stride of stream 1", offsetof(MeshFile::Header, streamStrides) + 4, header.streamStrides[1] + 4);
+    corrupt64("stream offset wrapping around", offsetof(MeshFile::Header, streamOffsets), ~std::uint64_t(0) - 4);
+    corrupt64("index offset past the end", offsetof(MeshFile::Header, indexOffset), bytes.size());
+
+    size_t attribute = header.attributeOffset + sizeof(MeshFile::Attribute);
+    corrupt32("attribute in a missing stream", attribute + offsetof(MeshFile::Attribute, stream), header.streamCount);
+    corrupt32("attribute in another stream", attribute + offsetof(MeshFile::Attribute, stream), 0);
+    corrupt32("attribute components", attribute + offsetof(MeshFile::Attribute, components), 5);
+    corrupt32("attribute type", attribute + offsetof(MeshFile::Attribute, type), GL_FLOAT);
+
+    corrupt32("submesh past the indices", header.submeshOffset + offsetof(MeshFile::Submesh, firstIndex), 2);
+    corrupt32("submesh index count overflowing", header.submeshOffset + offsetof(MeshFile::Submesh, indexCount), 0xFFFFFFFF);
+    std::uint16_t index = 4;
+    corrupt("index past the vertices", header.indexOffset + 2, &index, sizeof(index));
+
+    // Positions in stream 1 only: stream 0 has no attribute, hence no stride to count its vertices with
+    VertexLayout gapLayout;
+    gapLayout.Add(0, 3, GL_FLOAT, false, 0, 1);
+    if (MeshFile::Write(broken, gapLayout, gapLayout.Convert(vertices, 4, 8), 4, {0, 1, 2, 0, 2, 3}, {{0, 6, 0, 0}},
+                        boundsMin, boundsMax))
+    {
+        std::cerr << "FAILED: a layout with an empty stream was written" << std::endl;
+        failures++;
+    }
+
+    if (failures)
+        std::cerr << failures << " corrupt files opened" << std::endl;
+    else
+        std::cout << "Every corrupt file was rejected" << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+// Checks that TextureCache::Open() rejects truncated and corrupt cache files instead of handing out levels past
+// their end, or a chain the loader can't upload.
+// Usage: texture_cache_test <scratch folder>
+// Valid RGBA8 and BC1 caches of a 6x5 image are written, then copies of them with one field broken each: every
+// copy must fail to open.
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// TextureCache::Build() decodes with stb_image
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "textureCache.hpp"
+
+static constexpr std::uint64_t SOURCE_HASH = 42;
+
+static std::vector<unsigned char>
+ReadBytes(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void
+WriteBytes(const std::string &path, const std::vector<unsigned char> &bytes, size_t size)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(bytes.data()), size);
+}
+
+// @return The number of corrupt copies of a valid cache that opened.
+static int
+CheckFormat(const std::string &folder, std::uint32_t format, const char *name)
+{
+    std::string valid = folder + "/valid.ftx";
+    std::string broken = folder + "/broken.ftx";
+
+    // Odd sizes: the chain is 6x5, 3x2, 1x1 and the BC1 blocks overlap the edges
+    std::vector<unsigned char> pixels(6*5*3);
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+        pixels[i] = static_cast<unsigned char>(i*37);
+    }
+    TextureCache cache;
+    if (!TextureCache::Write(valid, SOURCE_HASH, pixels.data(), 6, 5, 3, format) || !cache.Open(valid, SOURCE_HASH))
+    {
+        std::cerr << "FAILED: the valid " << name << " cache doesn't open" << std::endl;
+        return 1;
+    }
+    const TextureCache::Header header = cache.GetHeader();
+    const TextureCache::Level firstLevel = cache.GetLevel(0);
+    const std::vector<unsigned char> bytes = ReadBytes(valid);
+
+    int failures = 0;
+    auto expectInvalid = [&](const std::string &what, const std::vector<unsigned char> &corrupt, size_t size)
+    {
+        WriteBytes(broken, corrupt, size);
+        TextureCache brokenCache;
+        if (brokenCache.Open(broken, SOURCE_HASH))
+        {
+            std::cerr << "FAILED: " << name << ": " << what << " opens" << std::endl;
+            failures++;
+        }
+    };
+    // Overwrites a field of the file, at its offset from the start
+    auto corrupt = [&](const std::string &what, size_t offset, const void *value, size_t size)
+    {
+        std::vector<unsigned char> copy = bytes;
+        std::memcpy(copy.data() + offset, value, size);
+        expectInvalid(what, copy, copy.size());
+    };
+    auto corrupt32 = [&](const std::string &what, size_t offset, std::uint32_t value)
+    {
+        corrupt(what, offset, &value, sizeof(value));
+    };
+    auto corrupt64 = [&](const std::string &what, size_t offset, std::uint64_t value)
+    {
+        corrupt(what, offset, &value, sizeof(value));
+    };
+
+    // Truncated in the header, the level table or the pixels
+    for (size_t size: {size_t(0), sizeof(TextureCache::Header)/2, sizeof(TextureCache::Header) + 4, bytes.size() - 1})
+    {
+        expectInvalid("truncated to " + std::to_string(size) + " bytes", bytes, size);
+    }
+
+    corrupt32("no level", offsetof(TextureCache::Header, levels), 0);
+    corrupt32("level count past the table", offsetof(TextureCache::Header, levels), 0x10000000);
+    corrupt32("a level after the 1x1 one", offsetof(TextureCache::Header, levels), header.levels + 1);
+    corrupt32("zero width", offsetof(TextureCache::Header, width), 0);
+    corrupt32("header wider than the first level", offsetof(TextureCache::Header, width), header.width * 2);
+    corrupt32("unknown format", offsetof(TextureCache::Header, format), 0x1908);
+
+    size_t level = sizeof(TextureCache::Header) + sizeof(TextureCache::Level);
+    corrupt32("level width", level + offsetof(TextureCache::Level, width), 2);
+    corrupt32("level height", level + offsetof(TextureCache::Level, height), 4);
+    corrupt64("level size too small", level + offsetof(TextureCache::Level, size), 4);
+    corrupt64("level size too large", level + offsetof(TextureCache::Level, size), bytes.size());
+    corrupt64("level offset past the end", level + offsetof(TextureCache::Level, offset), bytes.size());
+    corrupt64("level offset wrapping around", sizeof(TextureCache::Header) + offsetof(TextureCache::Level, offset),
+              ~std::uint64_t(0) - firstLevel.size/2);
+    return failures;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: texture_cache_test <scratch folder>" << std::endl;
+        return 1;
+    }
+    int failures = CheckFormat(argv[1], TextureCache::FORMAT_RGBA8, "RGBA8")
+                 + CheckFormat(argv[1], TextureCache::FORMAT_BC1, "BC1");
+    if (failures)
+        std::cerr << failures << " corrupt caches opened" << std::endl;
+    else
+        std::cout << "Every corrupt cache was rejected" << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,296 @@
+// Offline converter of Wavefront OBJ models to the binary mesh format (see MeshFile).
+// Usage: mesh_converter [--float] [--lods N] <model.obj> <model.fmesh>
+// Vertices are deduplicated and cache-optimized per material, then stored as half-float positions
+// and texture coordinates (float positions with --float) and 10-10-10-2 normals.
+// --lods N appends N simplified levels, each with half the triangles of the previous one (see MeshSimplifier):
+// they reuse the vertices and only add indices, stored level after level as submeshes of their lod.
+// Every level has one submesh per material group, a group too small to simplify repeats its previous level.
+// flipper maps these files and uploads them as they are.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "meshBuilder.hpp"
+#include "meshSimplifier.hpp"
+#include "meshFile.hpp"
+#include "vertexLayout.hpp"
+
+// Position, texture coordinates and normal
+static constexpr unsigned int SOURCE_STRIDE = 8;
+
+struct Group
+{
+    unsigned int material;
+    std::vector<float> vertices; // Unindexed triangle list
+};
+
+// @brief Resolves an OBJ index, 1-based or negative (relative to the end).
+static long
+ResolveIndex(const std::string &token, size_t count)
+{
+    if (token.empty())
+        return -1;
+    long index = std::strtol(token.c_str(), nullptr, 10);
+    if (index < 0)
+        index += static_cast<long>(count);
+    else
+        index--;
+    return index >= 0 && static_cast<size_t>(index) < count ? index : -1;
+}
+
+// @brief Reads every face of the model, triangulated as fans, grouped by material.
+static bool
+ParseObj(const std::string &path, std::vector<Group> &groups, std::vector<std::string> &materials)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Failed to open the model: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<float> positions, texCoords, normals;
+    Group *group = nullptr;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream stream(line);
+        std::string keyword;
+        stream >> keyword;
+        if (keyword == "v")
+        {
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            stream >> x >> y >> z;
+            positions.insert(positions.end(), {x, y, z});
+        }
+        else if (keyword == "vt")
+        {
+            float u = 0.0f, v = 0.0f;
+            stream >> u >> v;
+            texCoords.insert(texCoords.end(), {u, v});
+        }
+        else if (keyword == "vn")
+        {
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            stream >> x >> y >> z;
+            normals.insert(normals.end(), {x, y, z});
+        }
+        else if (keyword == "usemtl")
+        {
+            std::string name;
+            stream >> name;
+            unsigned int material = 0;
+            while (material < materials.size() && materials[material] != name)
+                material++;
+            if (material == materials.size())
+                materials.push_back(name);
+            groups.push_back({material, {}});
+            group = &groups.back();
+        }
+        else if (keyword == "f")
+        {
+            if (!group)
+            {
+                materials.push_back("default");
+                groups.push_back({0, {}});
+                group = &groups.back();
+            }
+
+            std::vector<float> face;
+            std::string corner;
+            bool hasNormals = true;
+            while (stream >> corner)
+            {
+                // v, v/vt, v//vn or v/vt/vn
+                size_t first = corner.find('/');
+                size_t second = first == std::string::npos ? std::string::npos : corner.find('/', first+1);
+                long p = ResolveIndex(corner.substr(0, first), positions.size()/3);
+                long t = first == std::string::npos ? -1 : ResolveIndex(corner.substr(first+1, second-first-1), texCoords.size()/2);
+                long n = second == std::string::npos ? -1 : ResolveIndex(corner.substr(second+1), normals.size()/3);
+                if (p < 0)
+                {
+                    std::cerr << "Invalid face in " << path << ": " << line << std::endl;
+                    return false;
+                }
+                float vertex[SOURCE_STRIDE] = {positions[3*p], positions[3*p+1], positions[3*p+2]};
+                if (t >= 0)
+                {
+                    vertex[3] = texCoords[2*t];
+                    vertex[4] = texCoords[2*t+1];
+                }
+                if (n >= 0)
+                {
+                    vertex[5] = normals[3*n];
+                    vertex[6] = normals[3*n+1];
+                    vertex[7] = normals[3*n+2];
+                }
+                hasNormals = hasNormals && n >= 0;
+                face.insert(face.end(), vertex, vertex+SOURCE_STRIDE);
+            }
+
+            size_t cornerCount = face.size()/SOURCE_STRIDE;
+            if (cornerCount < 3)
+                continue;
+            if (!hasNormals)
+            {
+                // Flat normal of the polygon (Newell's method)
+                float normal[3] = {};
+                for (size_t i = 0; i < cornerCount; i++)
+                {
+                    const float *a = &face[i*SOURCE_STRIDE];
+                    const float *b = &face[((i+1) % cornerCount)*SOURCE_STRIDE];
+                    normal[0] += (a[1]-b[1])*(a[2]+b[2]);
+                    normal[1] += (a[2]-b[2])*(a[0]+b[0]);
+                    normal[2] += (a[0]-b[0])*(a[1]+b[1]);
+                }
+                float length = std::sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+                for (size_t i = 0; i < cornerCount; i++)
+                {
+                    for (int c = 0; c < 3; c++)
+                        face[i*SOURCE_STRIDE+5+c] = length > 0.0f ? normal[c]/length : 0.0f;
+                }
+            }
+            for (size_t i = 1; i+1 < cornerCount; i++)
+            {
+                for (size_t corner : {size_t(0), i, i+1})
+                {
+                    group->vertices.insert(group->vertices.end(), face.begin() + corner*SOURCE_STRIDE,
+                                           face.begin() + (corner+1)*SOURCE_STRIDE);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bool floatPositions = false;
+    unsigned int lodCount = 0;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--float")
+            floatPositions = true;
+        else if (arg == "--lods" && i+1 < argc)
+            lodCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else
+            args.emplace_back(arg);
+    }
+    if (args.size() != 2)
+    {
+        std::cerr << "Usage: mesh_converter [--float] [--lods N] <model.obj> <model.fmesh>" << std::endl;
+        return 1;
+    }
+    if (args[0].size() < 4 || args[0].compare(args[0].size()-4, 4, ".obj"))
+    {
+        std::cerr << "Only Wavefront OBJ models are supported: " << args[0] << std::endl;
+        return 1;
+    }
+
+    std::vector<Group> groups;
+    std::vector<std::string> materials;
+    if (!ParseObj(args[0], groups, materials))
+        return 1;
+
+    // Every group becomes a submesh per level, its vertices appended after the previous ones
+    struct Level
+    {
+        unsigned int material;
+        unsigned int base;
+        std::vector<unsigned int> indices;
+    };
+    std::vector<std::vector<Level>> levels(lodCount+1);
+    std::vector<float> vertices;
+    size_t inputVertexCount = 0;
+    for (auto &group: groups)
+    {
+        if (group.vertices.empty())
+            continue;
+        MeshBuilder builder(group.vertices.data(), group.vertices.size()/SOURCE_STRIDE, SOURCE_STRIDE);
+        builder.Optimize();
+        inputVertexCount += builder.GetInputVertexCount();
+
+        unsigned int base = static_cast<unsigned int>(vertices.size()/SOURCE_STRIDE);
+        levels[0].push_back({group.material, base, builder.GetIndices()});
+        MeshSimplifier simplifier(builder.GetVertices().data(), builder.GetVertexCount(), SOURCE_STRIDE);
+        for (unsigned int lod = 1; lod <= lodCount; lod++)
+        {
+            // Always from the full mesh: errors don't add up along the chain
+            std::vector<unsigned int> simplified = simplifier.Simplify(builder.GetIndices(), std::ldexp(1.0f, -static_cast<int>(lod)));
+            // A group that can't get any simpler keeps its previous level: every level has every group,
+            // a level without it would leave a hole where its material was
+            if (simplified.size() >= levels[lod-1].back().indices.size())
+                simplified = levels[lod-1].back().indices;
+            levels[lod].push_back({group.material, base, std::move(simplified)});
+        }
+        vertices.insert(vertices.end(), builder.GetVertices().begin(), builder.GetVertices().end());
+    }
+
+    // Each level is contiguous, for ItemBuffer to draw it as one range
+    std::vector<unsigned int> indices;
+    std::vector<MeshFile::Submesh> submeshes;
+    for (unsigned int lod = 0; lod <= lodCount; lod++)
+    {
+        for (auto &level: levels[lod])
+        {
+            submeshes.push_back({static_cast<std::uint32_t>(indices.size()), static_cast<std::uint32_t>(level.indices.size()),
+                                 level.material, lod});
+            for (unsigned int index: level.indices)
+            {
+                indices.push_back(level.base + index);
+            }
+        }
+    }
+    if (indices.empty())
+    {
+        std::cerr << "No triangle in the model: " << args[0] << std::endl;
+        return 1;
+    }
+
+    size_t vertexCount = vertices.size()/SOURCE_STRIDE;
+    float boundsMin[3] = {vertices[0], vertices[1], vertices[2]};
+    float boundsMax[3] = {vertices[0], vertices[1], vertices[2]};
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            boundsMin[c] = std::min(boundsMin[c], vertices[v*SOURCE_STRIDE+c]);
+            boundsMax[c] = std::max(boundsMax[c], vertices[v*SOURCE_STRIDE+c]);
+        }
+    }
+
+    // Texture coordinates can repeat beyond [0, 1]: half floats rather than normalized shorts
+    VertexLayout layout;
+    layout.Add(0, 3, floatPositions ? GL_FLOAT : GL_HALF_FLOAT, false, 0)
+          .Add(1, 2, GL_HALF_FLOAT, false, 3)
+          .Add(3, 3, GL_INT_2_10_10_10_REV, true, 5);
+    auto streams = layout.Convert(vertices.data(), vertexCount, SOURCE_STRIDE);
+    if (!MeshFile::Write(args[1], layout, streams, vertexCount, indices, submeshes, boundsMin, boundsMax))
+    {
+        std::cerr << "Failed to write the mesh: " << args[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << args[0] << " -> " << args[1] << ": " << inputVertexCount << " vertices -> " << vertexCount
+              << " unique, " << indices.size()/3 << " triangles, " << submeshes.size() << " submeshes" << std::endl;
+    for (unsigned int lod = 0; lod <= lodCount && !levels[lod].empty(); lod++)
+    {
+        size_t triangles = 0;
+        for (auto &level: levels[lod])
+            triangles += level.indices.size()/3;
+        std::cout << "  lod " << lod << ": " << triangles << " triangles" << std::endl;
+    }
+    for (size_t m = 0; m < materials.size(); m++)
+    {
+        std::cout << "  material " << m << ": " << materials[m] << std::endl;
+    }
+    return 0;
+}
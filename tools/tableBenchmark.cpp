@@ -0,0 +1,111 @@
+// Benchmark of the table parser (see Table).
+// Usage: table_benchmark [entity count] [runs]
+// Writes a table of 100000 entities by default, then maps and parses it several times and prints the best
+// time, the throughput and the number of heap allocations of one load.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+
+#include "table.hpp"
+
+// Every heap allocation of the process goes through here
+static std::atomic<unsigned long> allocationCount {0};
+
+void *operator new(size_t size)
+{
+    allocationCount++;
+    if (void *memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+// @brief Writes a table with the given number of entities spread over a few meshes and materials.
+static bool
+WriteTable(const std::string &path, unsigned long count)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+        return false;
+
+    file << "# Generated by table_benchmark\n";
+    file << "entities " << count << "\n";
+    file << "mesh cube cube\nmesh bumper bumper.fmesh\nmesh flipper flipper.fmesh\n";
+    file << "material wood container.jpg\nmaterial smiley smiley.jpg\n";
+
+    const char *meshes[] = {"cube", "bumper", "flipper"};
+    const char *materials[] = {"wood", "smiley"};
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    char line[256];
+    for (unsigned long i = 0; i < count; i++)
+    {
+        std::snprintf(line, sizeof(line), "entity %s %s %.3f %.3f %.3f %.3f %.3f %.3f %.1f %.2f %.2f %.2f %.2f %.2f %.2f\n",
+                      meshes[i % 3], materials[i % 2], position(random), position(random), position(random),
+                      unit(random), unit(random), unit(random), 360.0f*unit(random),
+                      0.6f, 0.6f, 0.6f, 1.0f + unit(random), unit(random), unit(random));
+        file << line;
+    }
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int runs = argc > 2 ? std::atoi(argv[2]) : 10;
+    if (count > Table::MAX_ENTITIES)
+    {
+        std::cerr << "At most " << Table::MAX_ENTITIES << " entities per table" << std::endl;
+        return 1;
+    }
+    std::string path = (std::filesystem::temp_directory_path() / "table_benchmark.table").string();
+    if (!WriteTable(path, count))
+    {
+        std::cerr << "Failed to write the table: " << path << std::endl;
+        return 1;
+    }
+    double megabytes = std::filesystem::file_size(path) / (1024.0*1024.0);
+
+    double best = 1e9;
+    unsigned long allocations = 0;
+    for (int run = 0; run < std::max(runs, 1); run++)
+    {
+        Table table;
+        unsigned long allocationsBefore = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+        if (!table.Load(path))
+            return 1;
+        auto stop = std::chrono::steady_clock::now();
+        allocations = allocationCount - allocationsBefore;
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+        if (table.GetPlacements().size() != count)
+        {
+            std::cerr << "Parsed " << table.GetPlacements().size() << " entities instead of " << count << std::endl;
+            return 1;
+        }
+    }
+
+    std::printf("Table of %lu entities (%.1f MB): %.3f ms, %.0f MB/s, %.1f M entities/s, %lu allocations\n",
+                count, megabytes, best, megabytes/(best/1000.0), count/(best*1000.0), allocations);
+    std::filesystem::remove(path);
+    return 0;
+}
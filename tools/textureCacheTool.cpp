@@ -0,0 +1,69 @@
+// Offline builder of the GPU-ready texture cache (see TextureCache).
+// Usage: texture_cache [--bc1] <img folder> [image ...]
+// Writes <img folder>/cache/<image>.ftx for every image listed, or for every image of the folder.
+// flipper maps these files at launch instead of decoding the images.
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "textureCache.hpp"
+
+static bool
+IsImage(const std::filesystem::path &path)
+{
+    std::string extension = path.extension().string();
+    return extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".bmp" || extension == ".tga";
+}
+
+int main(int argc, char **argv)
+{
+    std::uint32_t format = TextureCache::FORMAT_RGBA8;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--bc1")
+            format = TextureCache::FORMAT_BC1;
+        else
+            args.emplace_back(arg);
+    }
+    if (args.empty())
+    {
+        std::cerr << "Usage: texture_cache [--bc1] <img folder> [image ...]" << std::endl;
+        return 1;
+    }
+
+    std::filesystem::path folder = args.front();
+    std::filesystem::path cacheFolder = folder / "cache";
+    std::filesystem::create_directories(cacheFolder);
+
+    std::vector<std::string> images(args.begin()+1, args.end());
+    if (images.empty())
+    {
+        for (auto &entry: std::filesystem::directory_iterator(folder))
+        {
+            if (entry.is_regular_file() && IsImage(entry.path()))
+                images.emplace_back(entry.path().filename().string());
+        }
+    }
+
+    int failures = 0;
+    for (auto &image: images)
+    {
+        std::filesystem::path cachePath = cacheFolder / (image + ".ftx");
+        if (TextureCache::Build((folder / image).string(), cachePath.string(), format))
+        {
+            std::cout << image << " -> " << cachePath.string() << std::endl;
+        }
+        else
+        {
+            failures++;
+        }
+    }
+    return failures ? 1 : 0;
+}
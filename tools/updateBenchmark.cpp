@@ -0,0 +1,78 @@
+// Scaling benchmark of the pose update system (see Packet::UpdateEntity()).
+// Usage: update_benchmark [max entity count] [max thread count] [runs]
+// Fills a World with 1k, 10k... up to 1M transforms by default and updates them all with 1 to N threads,
+// N being the number of cores. Prints the best time of each run and the speedup over one thread.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+#include "world.hpp"
+#include "components.hpp"
+#include "threadPool.hpp"
+
+// @brief The update of Packet::UpdateEntity() with index 0: spins every entity around its own axis.
+static void Update(Transform &transform)
+{
+    transform.rotationAngle += 0.016f;
+    transform.UpdateModel();
+}
+
+// @return The best time in milliseconds to update the whole world, serially when pool is nullptr.
+static double
+Measure(World &world, ThreadPool *pool, int runs)
+{
+    double best = 1e9;
+    for (int run = 0; run < runs; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (pool)
+            world.ParallelEach<Transform>(*pool, Update);
+        else
+            world.Each<Transform>(Update);
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long maxCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+    unsigned int maxThreads = argc > 2 ? std::max(std::atoi(argv[2]), 1) : cores;
+    int runs = argc > 3 ? std::max(std::atoi(argv[3]), 1) : 20;
+
+    // One pool per thread count, the calling thread counts as one
+    std::unique_ptr<ThreadPool> pools[64];
+    maxThreads = std::min(maxThreads, 64u);
+    for (unsigned int threads = 2; threads <= maxThreads; threads++)
+    {
+        pools[threads-1] = std::make_unique<ThreadPool>(threads-1);
+    }
+
+    std::printf("%10s %8s %10s %8s %12s\n", "entities", "threads", "ms", "speedup", "ns/entity");
+    for (unsigned long count = 1000; count <= maxCount; count *= 10)
+    {
+        World world;
+        world.Reserve<Transform>(count);
+        for (unsigned long i = 0; i < count; i++)
+        {
+            float position = static_cast<float>(i);
+            world.Create(Transform {glm::vec3(position, 0.0f, 0.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f),
+                                    glm::vec3(1.0f), glm::mat4(1.0f)});
+        }
+
+        double serial = Measure(world, nullptr, runs);
+        std::printf("%10lu %8u %10.3f %8.2f %12.2f\n", count, 1u, serial, 1.0, 1e6*serial/count);
+        for (unsigned int threads = 2; threads <= maxThreads; threads++)
+        {
+            double parallel = Measure(world, pools[threads-1].get(), runs);
+            std::printf("%10lu %8u %10.3f %8.2f %12.2f\n", count, threads, parallel, serial/parallel, 1e6*parallel/count);
+        }
+    }
+    return 0;
+}